@@ -0,0 +1,160 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * heatmap.cpp
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <cstdio>
+#include <cstring>
+
+#include <heatmap.h>
+
+
+/* Binary dump layout, all counters little endian uint64_t */
+static const char kHeatmapMagic[4] = { 'U', 'S', 'H', 'M' };
+static const uint32_t kHeatmapVersion = 1;
+
+/**
+ * @brief Construct a new heatmap::heatmap object
+ *
+ */
+heatmap::heatmap(void)
+{
+  clear();
+  return;
+}
+
+/**
+ * @brief Destroy the heatmap::heatmap object
+ *
+ */
+heatmap::~heatmap(void)
+{
+  return;
+}
+
+/**
+ * @brief Reset all counters
+ *
+ */
+void heatmap::clear(void)
+{
+  memset(page_reads, 0, sizeof(page_reads));
+  memset(page_writes, 0, sizeof(page_writes));
+  memset(page_execs, 0, sizeof(page_execs));
+  memset(io_reads, 0, sizeof(io_reads));
+  memset(io_writes, 0, sizeof(io_writes));
+  return;
+}
+
+/**
+ * @brief Dump the counters, CSV for a .csv path else binary
+ *
+ * @param path
+ * @return true on success
+ */
+bool heatmap::dump(const char *path)
+{
+  size_t len = strlen(path);
+  if (len >= 4 && !strcmp(&path[len - 4], ".csv")) {
+    return dump_csv(path);
+  }
+  return dump_binary(path);
+}
+
+/**
+ * @brief Dump the counters as CSV
+ *
+ * One row per page with any access, then one row per accessed IO
+ * register in $d000/$d03f, $d400/$d7ff, $dc00/$dcff and $dd00/$ddff
+ *
+ * @param path
+ * @return true on success
+ */
+bool heatmap::dump_csv(const char *path)
+{
+  FILE *f = fopen(path, "w");
+  if (f == NULL) {
+    MOSDBG("[HEAT] Unable to open %s\n", path);
+    return false;
+  }
+  fprintf(f, "kind,address,reads,writes,execs\n");
+  for (int page = 0; page < 0x100; page++) {
+    if (!(page_reads[page] | page_writes[page] | page_execs[page])) continue;
+    fprintf(f, "page,$%04x,%llu,%llu,%llu\n", (page << 8),
+      (unsigned long long)page_reads[page],
+      (unsigned long long)page_writes[page],
+      (unsigned long long)page_execs[page]);
+  }
+  for (int i = 0; i < 0x1000; i++) {
+    bool chip = (i < 0x40 || (i >= 0x400 && i < 0x800) || (i >= 0xc00 && i < 0xe00));
+    if (!chip || !(io_reads[i] | io_writes[i])) continue;
+    fprintf(f, "io,$%04x,%llu,%llu,0\n", (0xd000 + i),
+      (unsigned long long)io_reads[i],
+      (unsigned long long)io_writes[i]);
+  }
+  fclose(f);
+  MOSDBG("[HEAT] Written to %s\n", path);
+  return true;
+}
+
+/**
+ * @brief Dump the counters as binary
+ *
+ * "USHM", uint32_t version, then page reads, writes and execs
+ * [256] and IO reads and writes [4096] for $d000/$dfff
+ *
+ * @param path
+ * @return true on success
+ */
+bool heatmap::dump_binary(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    MOSDBG("[HEAT] Unable to open %s\n", path);
+    return false;
+  }
+  uint8_t version[4];
+  for (int i = 0; i < 4; i++) version[i] = ((kHeatmapVersion >> (i * 8)) & 0xff);
+  fwrite(kHeatmapMagic, 1, sizeof(kHeatmapMagic), f);
+  fwrite(version, 1, sizeof(version), f);
+  const uint64_t *tables[] = { page_reads, page_writes, page_execs, io_reads, io_writes };
+  const size_t sizes[] = { 0x100, 0x100, 0x100, 0x1000, 0x1000 };
+  for (size_t t = 0; t < count_of(tables); t++) {
+    for (size_t i = 0; i < sizes[t]; i++) {
+      uint8_t v[8];
+      for (int b = 0; b < 8; b++) v[b] = ((tables[t][i] >> (b * 8)) & 0xff);
+      fwrite(v, 1, sizeof(v), f);
+    }
+  }
+  bool ok = !ferror(f);
+  fclose(f);
+  MOSDBG("[HEAT] Written to %s\n", path);
+  return ok;
+}
@@ -0,0 +1,92 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * heatmap.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _HEATMAP_H
+#define _HEATMAP_H
+
+#include <cstdint>
+
+#include <c64util.h>
+
+
+/**
+ * @brief Memory and IO access counters for profiling tunes
+ *
+ * Counts reads, writes and executed instructions per 256 byte page
+ * and reads and writes per IO register in $d000/$dfff. VIC registers
+ * are folded onto $d000/$d03f, SID and CIA addresses are counted as
+ * accessed so mirror use stays visible. Instructions are counted as
+ * executes, their fetches mostly come from the predecode cache and
+ * do not show up as reads.
+ *
+ * Only the traced bus counts, so a disabled heat map costs nothing
+ */
+class heatmap
+{
+  public:
+    heatmap(void);
+    ~heatmap(void);
+
+    uint64_t page_reads[0x100];
+    uint64_t page_writes[0x100];
+    uint64_t page_execs[0x100];
+    uint64_t io_reads[0x1000];
+    uint64_t io_writes[0x1000];
+
+    /* io is true when addr went to a chip instead of RAM or ROM */
+    inline void read(uint16_t addr, bool io)
+    {
+      page_reads[(addr >> 8)]++;
+      if (io) io_reads[io_index(addr)]++;
+    };
+    inline void write(uint16_t addr, bool io)
+    {
+      page_writes[(addr >> 8)]++;
+      if (io) io_writes[io_index(addr)]++;
+    };
+    inline void exec(uint16_t pc) { page_execs[(pc >> 8)]++; };
+
+    void clear(void);
+    bool dump(const char *path);
+    bool dump_csv(const char *path);
+    bool dump_binary(const char *path);
+
+  private:
+    /* VIC mirrors fold onto their register */
+    static inline uint_fast16_t io_index(uint16_t addr)
+    {
+      return ((addr & 0x0c00) == 0 ? (addr & 0x3f) : (addr & 0xfff));
+    };
+};
+
+
+#endif /* _HEATMAP_H */
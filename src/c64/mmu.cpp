@@ -40,6 +40,7 @@
 #include <mos6560_6561_vic.h>
 #include <mos6581_8580_sid.h>
 #include <mos906114_pla.h>
+#include <heatmap.h>
 #include <mmu.h>
 
 #if EMBEDDED
@@ -73,6 +74,7 @@ mmu::mmu(void)
 
   /* Connect RAM pointer to RAM variable */
   memset(RAM,0,0x10000); /* Clear up that bitch */
+  memset(dirty,0xff,sizeof(dirty)); /* Everything changed */
 
   /* Set Data Direction bits defaults as per https://www.pagetable.com/c64ref/c64mem/ */
   RAM[pAddrDataDirection] = 0xef;
@@ -83,6 +85,12 @@ mmu::mmu(void)
   chargen = characters_901225_01;
   kernal = kernal_901227_03;
 
+  /* Default memory layout until the PLA sets up its banks */
+  bsc = krn = mos906114::kROM;
+  crg = mos906114::kIO;
+  map_banks(bsc, crg, krn);
+  map_io();
+
   return;
 }
 
@@ -109,19 +117,129 @@ void __us_not_in_flash_func(glue_c64) mmu::glue_c64(mos6510 *_cpu, mos906114 *_p
  cia1 = _cia1;
  cia2 = _cia2;
  sid = _sid;
+ map_io();
 
  return;
 }
 
+/**
+ * @brief Rebuild the page memory map for a bank configuration,
+ * called by the PLA whenever its banks change
+ *
+ * @param basic_bank
+ * @param chargen_bank
+ * @param kernal_bank
+ */
+void __us_not_in_flash_func(map_banks) mmu::map_banks(uint_fast8_t basic_bank, uint_fast8_t chargen_bank, uint_fast8_t kernal_bank)
+{
+  /* Drop cached code that got banked in or out */
+  if (cpu) {
+    if (basic_bank != bsc) cpu->predecode_flush(0xa0, 0xbf);
+    if (kernal_bank != krn) cpu->predecode_flush(0xe0, 0xff);
+  }
+  bsc = basic_bank;
+  crg = chargen_bank;
+  krn = kernal_bank;
+
+  /* Writes always end up in RAM unless IO is banked in */
+  for (int page = 0; page < 0x100; page++) {
+    read_map[page] = &RAM[(page << 8)];
+    write_map[page] = &RAM[(page << 8)];
+  }
+  /* $0000/$0001 ~ Data direction and memory layout */
+  write_map[0x00] = nullptr;
+  if (bsc == mos906114::kROM) {
+    for (int page = 0xa0; page <= 0xbf; page++) {
+      read_map[page] = &basic[((page - 0xa0) << 8)];
+    }
+  }
+  if (crg == mos906114::kIO) {
+    for (int page = 0xd0; page <= 0xdf; page++) {
+      /* $d800/$dbff ~ Color RAM stays plain RAM */
+      if (page >= (pAddrColorRAMFirstPage >> 8) && page <= (pAddrColorRAMLastPage >> 8)) continue;
+      read_map[page] = nullptr;
+      write_map[page] = nullptr;
+    }
+  } else if (crg == mos906114::kROM) {
+    for (int page = 0xd0; page <= 0xdf; page++) {
+      read_map[page] = &chargen[((page - 0xd0) << 8)];
+    }
+  }
+  if (krn == mos906114::kROM) {
+    for (int page = 0xe0; page <= 0xff; page++) {
+      read_map[page] = &kernal[((page - 0xe0) << 8)];
+    }
+  }
+
+  return;
+}
+
+/**
+ * @brief Set up the IO page handlers from the SID layout, call
+ * again whenever the SID addresses change
+ *
+ */
+void mmu::map_io(void)
+{
+  map_io_pages<trace_off>();
+  map_io_pages<trace_on>();
+  return;
+}
+
+template<class Trace>
+void mmu::map_io_pages(void)
+{
+  io_read_t * rd = io_read[Trace::enabled];
+  io_write_t * wr = io_write[Trace::enabled];
+  /* Unused pages and $d800/$dbff Color RAM */
+  for (int page = 0; page < 0x10; page++) {
+    rd[page] = &mmu::read_ram;
+    wr[page] = &mmu::write_ram;
+  }
+  /* $d000/$d3ff ~ VIC-II and its mirrors */
+  for (int page = 0x0; page <= 0x3; page++) {
+    rd[page] = &mmu::read_vic<Trace>;
+    wr[page] = &mmu::write_vic<Trace>;
+  }
+  /* $d400/$d7ff ~ SID and its mirrors */
+  for (int page = 0x4; page <= 0x7; page++) {
+    rd[page] = &mmu::read_sid<Trace>;
+    wr[page] = &mmu::write_sid<Trace>;
+  }
+  /* $dc00/$dcff ~ Cia 1, $dd00/$ddff ~ Cia 2 */
+  rd[0xc] = &mmu::read_cia1<Trace>;
+  wr[0xc] = &mmu::write_cia1<Trace>;
+  rd[0xd] = &mmu::read_cia2<Trace>;
+  wr[0xd] = &mmu::write_cia2<Trace>;
+  /* $de00/$dfff ~ IO1/IO2, only routed to the SID when one lives there */
+  if (sid) {
+    uint16_t sids[mos6581_8580::kMaxSids];
+    int numsids = sid->sid_bases(sids);
+    for (int i = 0; i < numsids; i++) {
+      if (sids[i] >= pAddrIO1Page) {
+        rd[((sids[i] >> 8) & 0xf)] = &mmu::read_sid<Trace>;
+        wr[((sids[i] >> 8) & 0xf)] = &mmu::write_sid<Trace>;
+      }
+    }
+    /* FMOpl at $df40/$df50 */
+    if (sid->fmoplsidno != 0) {
+      rd[0xf] = &mmu::read_sid<Trace>;
+      wr[0xf] = &mmu::write_sid<Trace>;
+    }
+  }
+  return;
+}
+
 /**
  * @brief IO Read from SID
  *
  * @param addr
  * @return uint8_t
  */
+template<class Trace>
 uint8_t __us_not_in_flash_func(read_sid) mmu::read_sid(uint16_t addr)
 {
-  return sid->read_sid(addr);
+  return sid->read_sid<Trace>(addr);
 }
 
 /**
@@ -130,52 +248,72 @@ uint8_t __us_not_in_flash_func(read_sid) mmu::read_sid(uint16_t addr)
  * @param addr
  * @param data
  */
+template<class Trace>
 void __us_not_in_flash_func(write_sid) mmu::write_sid(uint16_t addr, uint8_t data)
 {
-  sid->write_sid(addr,data);
+  sid->write_sid<Trace>(addr,data);
   return;
 }
 
 /**
- * @brief IO Read from Cia1/Cia2
+ * @brief IO Read from Cia1
  *
  * @param addr
  * @return uint8_t
  */
-uint8_t __us_not_in_flash_func(read_cia) mmu::read_cia(uint_least16_t addr)
+template<class Trace>
+uint8_t __us_not_in_flash_func(read_cia1) mmu::read_cia1(uint16_t addr)
 {
-  uint8_t data = RAM[addr]; /* Always read from RAM as fallback */
-  uint_least16_t cia_page = (addr & 0xFF00);
   uint8_t cia_addr = (addr & 0xF);
-  if (cia_page == pAddrCIA1Page) {
-    data = cia1->read_register(cia_addr);
-    if (log_cia1rw) MOSDBG("[R CIA1] $%04x $%02x:%02x\n",addr,cia_addr,data);
-  } else if (cia_page == pAddrCIA2Page) {
-    data = cia2->read_register(cia_addr);
-    if (log_cia2rw) MOSDBG("[R CIA2] $%04x $%02x:%02x\n",addr,cia_addr,data);
-  }
-
+  cia1->sync(cpu->cycles());
+  uint8_t data = cia1->read_register(cia_addr);
+  if (Trace::enabled && log_cia1rw) MOSDBG("[R CIA1] $%04x $%02x:%02x\n",addr,cia_addr,data);
   return data;
 }
 
 /**
- * @brief IO Write to Cia1/Cia2
+ * @brief IO Write to Cia1
  *
  * @param addr
  * @param data
  */
-void __us_not_in_flash_func(write_cia) mmu::write_cia(uint_least16_t addr, uint8_t data)
+template<class Trace>
+void __us_not_in_flash_func(write_cia1) mmu::write_cia1(uint16_t addr, uint8_t data)
+{
+  if (Trace::enabled && log_cia1rw) MOSDBG("[W CIA1] $%04x:%02x\n",addr,data);
+  cia1->sync(cpu->cycles());
+  cia1->write_register((addr & 0xF),data);
+  return;
+}
+
+/**
+ * @brief IO Read from Cia2
+ *
+ * @param addr
+ * @return uint8_t
+ */
+template<class Trace>
+uint8_t __us_not_in_flash_func(read_cia2) mmu::read_cia2(uint16_t addr)
 {
-  uint_least16_t cia_page = (addr & 0xFF00);
   uint8_t cia_addr = (addr & 0xF);
-  if (cia_page == pAddrCIA1Page) {
-    if (log_cia1rw) MOSDBG("[W CIA1] $%04x:%02x\n",addr,data);
-    cia1->write_register(cia_addr,data);
-  } else if (cia_page == pAddrCIA2Page) {
-    if (log_cia2rw) MOSDBG("[W CIA2] $%04x:%02x\n",addr,data);
-    cia2->write_register(cia_addr,data);
-  }
+  cia2->sync(cpu->cycles());
+  uint8_t data = cia2->read_register(cia_addr);
+  if (Trace::enabled && log_cia2rw) MOSDBG("[R CIA2] $%04x $%02x:%02x\n",addr,cia_addr,data);
+  return data;
+}
 
+/**
+ * @brief IO Write to Cia2
+ *
+ * @param addr
+ * @param data
+ */
+template<class Trace>
+void __us_not_in_flash_func(write_cia2) mmu::write_cia2(uint16_t addr, uint8_t data)
+{
+  if (Trace::enabled && log_cia2rw) MOSDBG("[W CIA2] $%04x:%02x\n",addr,data);
+  cia2->sync(cpu->cycles());
+  cia2->write_register((addr & 0xF),data);
   return;
 }
 
@@ -185,15 +323,13 @@ void __us_not_in_flash_func(write_cia) mmu::write_cia(uint_least16_t addr, uint8
  * @param addr
  * @return uint8_t
  */
-uint8_t __us_not_in_flash_func(read_vic) mmu::read_vic(uint_least16_t addr)
+template<class Trace>
+uint8_t __us_not_in_flash_func(read_vic) mmu::read_vic(uint16_t addr)
 {
-  uint8_t data = 0xff;
   uint8_t vic_addr = (addr & 0x3f);
-  if (log_vicrw) MOSDBG("[R  VIC] $%04x:%02x\n",addr,data);
-  if _MOS_LIKELY (vic_addr <=0x3f) {
-    data = vic->read_register(vic_addr);
-  }
-
+  vic->sync(cpu->cycles());
+  uint8_t data = vic->read_register(vic_addr);
+  if (Trace::enabled && log_vicrw) MOSDBG("[R  VIC] $%04x:%02x\n",addr,data);
   return data;
 }
 
@@ -203,46 +339,28 @@ uint8_t __us_not_in_flash_func(read_vic) mmu::read_vic(uint_least16_t addr)
  * @param addr
  * @param data
  */
-void __us_not_in_flash_func(write_vic) mmu::write_vic(uint_least16_t addr, uint8_t data)
+template<class Trace>
+void __us_not_in_flash_func(write_vic) mmu::write_vic(uint16_t addr, uint8_t data)
 {
-  uint8_t vic_addr = (addr & 0x3F);
-  if _MOS_LIKELY (vic_addr <=0x3f) {
-    vic->write_register(vic_addr,data);
-  }
-  if (log_vicrw) MOSDBG("[W  VIC] $%04x:%02x\n",addr,data);
-
+  vic->sync(cpu->cycles());
+  vic->write_register((addr & 0x3f),data);
+  if (Trace::enabled && log_vicrw) MOSDBG("[W  VIC] $%04x:%02x\n",addr,data);
   return;
 }
 
 /**
- * @brief Reads a byte of data from ROM based on the provided
- * ROM type
+ * @brief IO pages without a chip read and write RAM
  *
- * @param addr
- * @param rom
- * @return uint8_t
  */
-uint8_t __us_not_in_flash_func(rom_read_byte) mmu::rom_read_byte(uint16_t addr, char rom)
+uint8_t __us_not_in_flash_func(read_ram) mmu::read_ram(uint16_t addr)
 {
-  uint8_t data;
-  switch (rom) {
-    case 'B':
-      data = basic[addr];
-      break;
-    case 'C':
-      data = chargen[addr];
-      break;
-    case 'K':
-      data = kernal[addr];
-      break;
-    default:
-      break;
-  }
-  if (log_romrw) {
-    MOSDBG("[R  ROM]$%04x:%02x [B%dC%dK%d]\n",
-      addr,data,bsc,crg,krn);
-  }
-  return data;
+  return RAM[addr];
+}
+
+void __us_not_in_flash_func(write_ram) mmu::write_ram(uint16_t addr, uint8_t data)
+{
+  dma_write_ram(addr, data);
+  return;
 }
 
 /**
@@ -280,99 +398,78 @@ uint8_t __us_not_in_flash_func(vic_read_byte) mmu::vic_read_byte(uint16_t addr)
 }
 
 /**
- * @brief Read a byte of data from address with regards to
- * the configured memory layout, will read from RAM if no
- * IO is needed
+ * @brief Read from a page that is not mapped to RAM or ROM,
+ * only the IO pages when IO is banked in
  *
  * @param addr
  * @return uint8_t
  */
-uint8_t __us_not_in_flash_func(read_byte) mmu::read_byte(uint16_t addr)
+template<class Trace>
+uint8_t __us_not_in_flash_func(read_io) mmu::read_io(uint16_t addr)
 {
-  bsc = pla->memory_banks(mos906114::kBankBasic);
-  crg = pla->memory_banks(mos906114::kBankChargen);
-  krn = pla->memory_banks(mos906114::kBankKernal);
-
-  bool read_io = (crg == mos906114::kIO);
-  bool b_rom = (bsc == mos906114::kROM);
-  bool c_rom = (crg == mos906114::kROM);
-  bool k_rom = (krn == mos906114::kROM);
+  return (this->*io_read[Trace::enabled][((addr >> 8) & 0xf)])(addr);
+}
 
-  /* Always read from RAM first as default, gets overriden by actual read */
-  uint8_t data = RAM[addr];
+/**
+ * @brief Write to a page that is not mapped to RAM, the IO pages
+ * when IO is banked in and the zero page with the cpu port
+ *
+ * @param addr
+ * @param data
+ */
+template<class Trace>
+void __us_not_in_flash_func(write_io) mmu::write_io(uint16_t addr, uint8_t data)
+{
+  if _MOS_LIKELY (addr >= pAddrVicFirstPage) {
+    (this->*io_write[Trace::enabled][((addr >> 8) & 0xf)])(addr, data);
+    return;
+  }
   switch (addr) {
     /* $0000 */
     case pAddrDataDirection:
-      /* TODO: Add routine? */
-      break;
+      /* TODO: Add something */
+      return;
     /* $0001 */
     case pAddrMemoryLayout:
-      /* TODO: Add routine? */
-      break;
-    /* $a000/$bfff ~ Basic ROM or RAM */
-    case pAddrBasicFirstPage ... (pAddrBasicLastPage + pC64PageEnd):
-      if (b_rom) {
-        data = rom_read_byte((addr&0x1fff), 'B');
-      }
-      break;
-    /* $d000/$d3ff ~ Character ROM or VIC-II DMA */
-    case pAddrVicFirstPage ... (pAddrVicLastPage + pC64PageEnd):
-      if _MOS_LIKELY (read_io) {
-        data = read_vic(addr);
-      } else if _MOS_UNLIKELY (c_rom) {
-        data = rom_read_byte((addr&0x0fff), 'C');
-      }
-      break;
-    /* $d400/$d7ff ~ SID audio */
-    case pAddrSIDFirstPage ... (pAddrSIDLastPage + pC64PageEnd):
-      if _MOS_LIKELY (read_io) {
-        data = read_sid(addr);
-      } else if _MOS_UNLIKELY (c_rom) {
-        data = rom_read_byte((addr&0x0fff), 'C');
-      }
-      break;
-    /* $d800/$dbff ~ Color RAM */
-    case pAddrColorRAMFirstPage ... (pAddrColorRAMLastPage + pC64PageEnd):
-      if (c_rom) {
-        data = rom_read_byte((addr&0x0fff), 'C');
-      }
-      break;
-    /* $dc00/$dcff ~ Cia 1 */
-    case pAddrCIA1Page ... (pAddrCIA1Page + pC64PageEnd):
-      if _MOS_LIKELY (read_io) {
-        data = read_cia(addr);
-      } else if _MOS_UNLIKELY (c_rom) {
-        data = rom_read_byte((addr&0x0fff), 'C');
-      }
-      break;
-    /* $dd00/$ddff ~ Cia 2 */
-    case pAddrCIA2Page ... (pAddrCIA2Page + pC64PageEnd):
-      if _MOS_LIKELY (read_io) {
-        data = read_cia(addr);
-      } else if _MOS_UNLIKELY (c_rom) {
-        data = rom_read_byte((addr&0x0fff), 'C');
-      }
-      break;
-    /* $de00/$dfff ~ IO or RAM */
-    case pAddrIO1Page ... (pAddrIO2Page + pC64PageEnd):
-      if _MOS_LIKELY (read_io) {
-        data = read_sid(addr);
-      } else if _MOS_UNLIKELY (c_rom) {
-        data = rom_read_byte((addr&0x0fff ), 'C');
-      }
-      break;
-    /* $e000/$ffff ~ Kernal ROM or RAM*/
-    case pAddrKernalFirstPage ... (pAddrKernalLastPage + pC64PageEnd):
-      if (k_rom) {
-        data = rom_read_byte((addr&0x1fff), 'K');
-      }
-      break;
+      pla->runtime_bank_switching(data);
+      return;
     default:
       break;
   }
-  if (log_readwrites)
+  /* Rest of the zero page is RAM */
+  RAM[addr] = data;
+  mark_dirty(addr);
+  cpu->predecode_invalidate(addr);
+  return;
+}
+
+/**
+ * @brief Read a byte of data from address with regards to
+ * the configured memory layout, RAM and ROM pages are read
+ * straight from the memory map
+ *
+ * @param addr
+ * @return uint8_t
+ */
+template<class Trace>
+uint8_t __us_not_in_flash_func(read_byte) mmu::read_byte(uint16_t addr)
+{
+  const uint8_t * page = read_map[(addr >> 8)];
+  uint8_t data;
+  if _MOS_LIKELY (page != nullptr) {
+    data = page[(addr & 0xff)];
+    if (Trace::enabled && log_romrw && page != &RAM[(addr & 0xff00)]) {
+      MOSDBG("[R  ROM]$%04x:%02x [B%dC%dK%d]\n",
+        addr,data,bsc,crg,krn);
+    }
+  } else {
+    data = read_io<Trace>(addr);
+  }
+  if (Trace::enabled && heat) heat->read(addr, (page == nullptr));
+  if (Trace::enabled && log_readwrites)
     MOSDBG("[R MEM %d%d%d%d]$%04x:%02x\n",
-      read_io,b_rom,c_rom,k_rom,addr,data);
+      (crg == mos906114::kIO),(bsc == mos906114::kROM),
+      (crg == mos906114::kROM),(krn == mos906114::kROM),addr,data);
   return data;
 }
 
@@ -384,61 +481,35 @@ uint8_t __us_not_in_flash_func(read_byte) mmu::read_byte(uint16_t addr)
  * @param addr
  * @param data
  */
+template<class Trace>
 void __us_not_in_flash_func(write_byte) mmu::write_byte(uint16_t addr, uint8_t data)
 {
-  crg = pla->memory_banks(mos906114::kBankChargen);
-  bool write_io = (crg == mos906114::kIO);
-
-  if (log_readwrites) MOSDBG("[W MEM %d___]$%04x:%02x\n",write_io,addr,data);
-  switch (addr) {
-    /* $0000 */
-    case pAddrDataDirection:
-      /* TODO: Add something */
-      return;
-    /* $0001 */
-    case pAddrMemoryLayout:
-      pla->runtime_bank_switching(data);
-      return;
-    /* $d000/$d3ff ~ VIC-II DMA or Character ROM */
-    case pAddrVicFirstPage ... (pAddrVicLastPage + pC64PageEnd):
-      if _MOS_LIKELY (write_io) {
-        write_vic(addr, data);
-        return;
-      }
-      break;
-    /* $d400/$d7ff ~ SID audio */
-    case pAddrSIDFirstPage ... (pAddrSIDLastPage + pC64PageEnd):
-      if _MOS_LIKELY (write_io) {
-        write_sid(addr, data);
-        return;
-      }
-      break;
-    /* $dc00/$dcff ~ Cia 1 */
-    case pAddrCIA1Page ... (pAddrCIA1Page + pC64PageEnd):
-      if _MOS_LIKELY (write_io) {
-        write_cia(addr, data);
-        return;
-      }
-      break;
-    /* $dd00/$ddff ~ Cia 2 */
-    case pAddrCIA2Page ... (pAddrCIA2Page + pC64PageEnd):
-      if _MOS_LIKELY (write_io) {
-        write_cia(addr, data);
-        return;
-      }
-      break;
-    /* $de00/$dfff ~ IO or RAM */
-    case pAddrIO1Page ... (pAddrIO2Page + pC64PageEnd):
-      if _MOS_LIKELY (write_io) {
-        write_sid(addr, data);
-        return;
-      }
-      break;
-    default:
-      break;
+  if (Trace::enabled && log_readwrites) MOSDBG("[W MEM %d___]$%04x:%02x\n",(crg == mos906114::kIO),addr,data);
+  uint8_t * page = write_map[(addr >> 8)];
+  if (Trace::enabled && heat) heat->write(addr, (page == nullptr && addr >= pAddrVicFirstPage));
+  if _MOS_LIKELY (page != nullptr) {
+    page[(addr & 0xff)] = data;
+    mark_dirty(addr);
+    cpu->predecode_invalidate(addr);
+  } else {
+    write_io<Trace>(addr, data);
   }
-  /* Always write to RAM in all other cases */
-  RAM[addr] = data;
+  return;
+}
+
+template uint8_t mmu::read_byte<trace_off>(uint16_t addr);
+template uint8_t mmu::read_byte<trace_on>(uint16_t addr);
+template void mmu::write_byte<trace_off>(uint16_t addr, uint8_t data);
+template void mmu::write_byte<trace_on>(uint16_t addr, uint8_t data);
+
+/**
+ * @brief Returns the C64 RAM for direct access by the cpu
+ *
+ * @return uint8_t*
+ */
+uint8_t * mmu::ram(void)
+{
+  return RAM;
 }
 
 uint8_t __us_not_in_flash_func(dma_read_ram) mmu::dma_read_ram(uint16_t addr)
@@ -450,6 +521,129 @@ uint8_t __us_not_in_flash_func(dma_read_ram) mmu::dma_read_ram(uint16_t addr)
 void __us_not_in_flash_func(dma_write_ram) mmu::dma_write_ram(uint16_t addr, uint8_t data)
 {
   RAM[addr] = data;
+  mark_dirty(addr);
+  if (cpu) cpu->predecode_invalidate(addr);
   /* MOSDBG("[DMA WRITE] $%04x:%02x(%02x)\n", addr, data, RAM[addr]); */
   return;
 }
+
+/**
+ * @brief Clamp a block length to the 64K address space
+ *
+ */
+size_t mmu::dma_clamp(size_t len)
+{
+  if _MOS_UNLIKELY (len > 0x10000) {
+    MOSDBG("[DMA] Block of %zu bytes clamped to 64K\n", len);
+    len = 0x10000;
+  }
+  return len;
+}
+
+/**
+ * @brief Mark the pages a block transfer touched dirty and drop
+ * cached code in them
+ *
+ */
+void mmu::dma_invalidate(uint16_t addr, size_t len)
+{
+  if (len == 0) return;
+  uint_fast32_t last = (addr + len - 1);
+  for (uint_fast32_t page = (addr >> 8); page <= (last >> 8); page++) {
+    mark_dirty((uint16_t)(page << 8));
+  }
+  if (cpu == nullptr) return;
+  if (last <= 0xffff) {
+    cpu->predecode_flush((addr >> 8), (last >> 8));
+  } else {
+    cpu->predecode_flush((addr >> 8), 0xff);
+    cpu->predecode_flush(0x00, ((last & 0xffff) >> 8));
+  }
+  return;
+}
+
+/**
+ * @brief Copy len bytes of RAM starting at addr into data
+ *
+ * @param addr
+ * @param data
+ * @param len
+ */
+void __us_not_in_flash_func(dma_read_block) mmu::dma_read_block(uint16_t addr, uint8_t *data, size_t len)
+{
+  len = dma_clamp(len);
+  size_t first = MIN(len, (size_t)(0x10000 - addr));
+  memcpy(data, &RAM[addr], first);
+  if (len > first) memcpy(&data[first], RAM, (len - first));
+  return;
+}
+
+/**
+ * @brief Copy len bytes from data into RAM starting at addr
+ *
+ * @param addr
+ * @param data
+ * @param len
+ */
+void __us_not_in_flash_func(dma_write_block) mmu::dma_write_block(uint16_t addr, const uint8_t *data, size_t len)
+{
+  len = dma_clamp(len);
+  size_t first = MIN(len, (size_t)(0x10000 - addr));
+  memcpy(&RAM[addr], data, first);
+  if (len > first) memcpy(RAM, &data[first], (len - first));
+  dma_invalidate(addr, len);
+  return;
+}
+
+/**
+ * @brief Fill len bytes of RAM starting at addr with value
+ *
+ * @param addr
+ * @param value
+ * @param len
+ */
+void __us_not_in_flash_func(dma_fill) mmu::dma_fill(uint16_t addr, uint8_t value, size_t len)
+{
+  len = dma_clamp(len);
+  size_t first = MIN(len, (size_t)(0x10000 - addr));
+  memset(&RAM[addr], value, first);
+  if (len > first) memset(RAM, value, (len - first));
+  dma_invalidate(addr, len);
+  return;
+}
+
+/**
+ * @brief Returns the first dirty page at or after page
+ *
+ * @param page
+ * @return int page number or -1 if none is dirty
+ */
+int mmu::next_dirty_page(int page)
+{
+  for (; page < 0x100; page = ((page | 0x3f) + 1)) {
+    uint64_t bits = (dirty[(page >> 6)] >> (page & 0x3f));
+    if (bits) return (page + __builtin_ctzll(bits));
+  }
+  return -1;
+}
+
+/**
+ * @brief Mark all pages clean
+ *
+ */
+void mmu::clear_dirty(void)
+{
+  memset(dirty,0,sizeof(dirty));
+  return;
+}
+
+/**
+ * @brief Mark a single page clean
+ *
+ * @param page
+ */
+void mmu::clear_dirty(uint8_t page)
+{
+  dirty[(page >> 6)] &= ~(1ULL << (page & 0x3f));
+  return;
+}
@@ -33,13 +33,17 @@
 #ifndef _US_MMU_H_
 #define _US_MMU_H_
 
+#include <cstddef>
 #include <cstdint>
 
+#include <c64util.h>
+
 class mos6510;
 class mos6526;
 class mos6560_6561;
 class mos6581_8580;
 class mos906114;
+class heatmap;
 
 /**
  * @brief C64 Memory Management Unit
@@ -59,15 +63,17 @@ class mmu
     bool log_vicrrw = false;
     bool log_cia1rw = false;
     bool log_cia2rw = false;
+    /* Access counters, only updated by the traced bus */
+    heatmap * heat = nullptr;
 
   private:
     /* Glue */
-    mos6510 * cpu;
+    mos6510 * cpu = nullptr;
     mos906114 * pla;
     mos6560_6561 * vic;
     mos6526 * cia1;
     mos6526 * cia2;
-    mos6581_8580 * sid;
+    mos6581_8580 * sid = nullptr;
 
     const unsigned char * basic;
     const unsigned char * chargen;
@@ -75,23 +81,62 @@ class mmu
 
     uint_fast8_t bsc, crg, krn;
 
-    inline uint8_t read_sid(uint16_t addr);
-    inline void write_sid(uint16_t addr, uint8_t data);
-    inline uint8_t read_cia(uint_least16_t addr);
-    inline void write_cia(uint_least16_t addr, uint8_t data);
-    inline uint8_t read_vic(uint_least16_t addr);
-    inline void write_vic(uint_least16_t addr, uint8_t data);
-    inline uint8_t rom_read_byte(uint16_t addr, char rom);
+    /* Memory map per 256 byte page, rebuilt by map_banks(). A page
+     * points at RAM or ROM, nullptr means the access goes through
+     * the IO/special case path */
+    const uint8_t * read_map[0x100];
+    uint8_t * write_map[0x100];
+
+    /* One bit per 256 byte RAM page written since the last clear */
+    uint64_t dirty[4];
+
+    /* Handler per IO page $d000/$dfff, set up by map_io(),
+     * indexed by [Trace::enabled][page] */
+    typedef uint8_t (mmu::*io_read_t)(uint16_t addr);
+    typedef void (mmu::*io_write_t)(uint16_t addr, uint8_t data);
+    io_read_t io_read[2][0x10];
+    io_write_t io_write[2][0x10];
+
+    template<class Trace> uint8_t read_sid(uint16_t addr);
+    template<class Trace> void write_sid(uint16_t addr, uint8_t data);
+    template<class Trace> uint8_t read_cia1(uint16_t addr);
+    template<class Trace> void write_cia1(uint16_t addr, uint8_t data);
+    template<class Trace> uint8_t read_cia2(uint16_t addr);
+    template<class Trace> void write_cia2(uint16_t addr, uint8_t data);
+    template<class Trace> uint8_t read_vic(uint16_t addr);
+    template<class Trace> void write_vic(uint16_t addr, uint8_t data);
+    uint8_t read_ram(uint16_t addr);
+    void write_ram(uint16_t addr, uint8_t data);
+    template<class Trace> void map_io_pages(void);
+    template<class Trace> uint8_t read_io(uint16_t addr);
+    template<class Trace> void write_io(uint16_t addr, uint8_t data);
+    size_t dma_clamp(size_t len);
+    void dma_invalidate(uint16_t addr, size_t len);
 
   public:
     void glue_c64(mos6510 *_cpu, mos906114 *_pla, mos6560_6561 *_vic, mos6526 *_cia1, mos6526 *_cia2, mos6581_8580 *_sid);
+    void map_banks(uint_fast8_t basic_bank, uint_fast8_t chargen_bank, uint_fast8_t kernal_bank);
+    void map_io(void);
 
     uint8_t vic_read_byte(uint16_t addr);
-    uint8_t read_byte(uint16_t addr);
-    void write_byte(uint16_t addr, uint8_t data);
+    /* Trace selects the instantiation with the read/write logging compiled in */
+    template<class Trace = trace_off> uint8_t read_byte(uint16_t addr);
+    template<class Trace = trace_off> void write_byte(uint16_t addr, uint8_t data);
 
     uint8_t dma_read_ram(uint16_t addr);
     void dma_write_ram(uint16_t addr, uint8_t data);
+    /* Block transfers, len is clamped to 64K and wraps at $ffff */
+    void dma_read_block(uint16_t addr, uint8_t *data, size_t len);
+    void dma_write_block(uint16_t addr, const uint8_t *data, size_t len);
+    void dma_fill(uint16_t addr, uint8_t value, size_t len);
+    uint8_t * ram(void);
+
+    /* Dirty page tracking, any write to RAM marks its page */
+    inline void mark_dirty(uint16_t addr) { dirty[(addr >> 14)] |= (1ULL << ((addr >> 8) & 0x3f)); };
+    inline bool page_dirty(uint8_t page) { return ((dirty[(page >> 6)] >> (page & 0x3f)) & 1); };
+    int next_dirty_page(int page);
+    void clear_dirty(void);
+    void clear_dirty(uint8_t page);
 
 };
 
@@ -29,6 +29,8 @@
  *
  */
 
+#include <cstring>
+
 #include <mmu.h>
 #include <mos6510_cpu.h>
 #include <mos6560_6561_vic.h>
@@ -36,21 +38,6 @@
 #include <c64util.h>
 
 
-/**
- * @brief Init static CPU variables
- */
-CPUCLOCK mos6510::cycles_ = 0;
-CPUCLOCK mos6510::prev_cycles_ = 0;
-
-bool mos6510::loginstructions = false;
-bool mos6510::pending_interrupt = false;
-bool mos6510::irq_pending = false;
-bool mos6510::nmi_pending = false;
-
-val_t mos6510::last_insn = 0;
-addr_t mos6510::pc_address = 0;
-addr_t mos6510::d_address = 0;
-
 /**
  * @brief Construct a new mos6510::mos6510 object
  *
@@ -63,7 +50,6 @@ mos6510::mos6510(BusRead r, BusWrite w)
 
   read_bus = (BusRead)r;
   write_bus = (BusWrite)w;
-  fill_instruction_table();
 
   a_ = x_ = y_ = sp_ = 0x0;
   _flags = 0b00110000;
@@ -79,19 +65,24 @@ mos6510::mos6510(BusRead r, BusWrite w)
 mos6510::~mos6510()
 {
   MOSDBG("[CPU] Deinit\n");
-  initialized = false;
-  instruction_table.fill(InstructionHandler{});
-
-  /* Variables to default state */
-  cycles_ = 0;
-  prev_cycles_ = 0;
-  loginstructions = false;
-  pending_interrupt = false;
-  irq_pending = false;
-  nmi_pending = false;
-  last_insn = 0;
-  pc_address = 0;
-  d_address = 0;
+
+  if (predecode_enabled) { dump_predecode_stats(); }
+  for (size_t i = 0; i < count_of(predecode_); i++) {
+    delete predecode_[i];
+    predecode_[i] = nullptr;
+  }
+  if (superblocks_enabled) { dump_superblock_stats(); }
+  if (idle_skip_enabled) {
+    MOSDBG("[CPU] Idle loops skipped %llu cycles in %llu jumps\n",
+      (unsigned long long)idle_skipped_cycles_, (unsigned long long)idle_skips_);
+  }
+  MOSDBG("[CPU] Alarms dispatched %llu\n", (unsigned long long)alarms.dispatched());
+  for (size_t i = 0; i < count_of(superblocks_); i++) {
+    if (superblocks_[i] == nullptr) continue;
+    for (int j = 0; j < 0x100; j++) delete superblocks_[i][j];
+    delete[] superblocks_[i];
+    superblocks_[i] = nullptr;
+  }
 
   return;
 }
@@ -106,7 +97,23 @@ void __us_not_in_flash_func(glue_c64) mos6510::glue_c64(mmu *_mmu, mos6560_6561
   vic  = _vic;
   cia1 = _cia1;
   cia2 = _cia2;
+  direct_ram(true);
+
+  return;
+}
 
+/**
+ * @brief Enable or disable direct RAM access
+ *
+ * When disabled every access goes through the bus callbacks,
+ * needed for the read/write logging to see all of them
+ *
+ * @param enable
+ */
+void mos6510::direct_ram(bool enable)
+{
+  ram_ = (mmu_ ? mmu_->ram() : nullptr);
+  ram_span_ = ((enable && ram_) ? (pBaseAddrStack + 0x100 - 2) : 0);
   return;
 }
 
@@ -124,6 +131,7 @@ void __us_not_in_flash_func(reset) mos6510::reset(void)
   val_t pc_hi = load_byte(pAddrResetVector+1);
   pc(pc_lo | pc_hi << 8);
   prev_cycles_ = 0, cycles_ = 6;
+  predecode_flush(0x00, 0xff);
 
   return;
 }
@@ -141,311 +149,6 @@ void __us_not_in_flash_func(hot_reset) mos6510::hot_reset(void)
   return;
 }
 
-/**
- * @brief Fill the CPU instruction table with opcodes
- *
- */
-
-void __us_not_in_flash_func(fill_instruction_table) mos6510::fill_instruction_table(void)
-{
-	if (initialized) return;
-	initialized = true;
-  { /* Fill instruction_table */
-    /* 0x00 ~ 0x0F */
-    instruction_table[0x00] = [this]() { this->brk(); };                                           /* BRK impl */
-    instruction_table[0x01] = [this]() { this->ora(this->load_byte(this->addr_indx()), 6); };      /* ORA (ind,X) */
-    instruction_table[0x02] = [this]() { this->jam(0x02); };                                       /* JAM ~ Illegal OPCode */
-    instruction_table[0x03] = [this]() { this->slo(this->addr_indx(), 5, 3); };                    /* SLO (ind,X) ~ Illegal OPCode */
-    instruction_table[0x04] = [this]() { this->load_byte(addr_zero()); this->nop(3); };            /* NOP zpg ~ Illegal OPCode */
-    instruction_table[0x05] = [this]() { this->ora(this->load_byte(this->addr_zero()), 3); };      /* ORA zpg */
-    instruction_table[0x06] = [this]() { this->asl_mem(this->addr_zero(), 5); };                   /* ASL zpg */
-    instruction_table[0x07] = [this]() { this->slo(this->addr_zero(), 3, 2); };                    /* SLO zpg ~ Illegal OPCode */
-    instruction_table[0x08] = [this]() { this->php(); };                                           /* PHP impl */
-    instruction_table[0x09] = [this]() { this->ora(this->fetch_op(), 2); };                        /* ORA #imm */
-    instruction_table[0x0A] = [this]() { this->asl_a(); };                                         /* ASL A */
-    instruction_table[0x0B] = [this]() { this->anc(this->fetch_op()); };                           /* ANC(AAC) #imm ~ Illegal OPCode */
-    instruction_table[0x0C] = [this]() { this->load_byte(this->addr_abs()); this->nop(4); };       /* NOP abs  ~ Illegal OPCode */
-    instruction_table[0x0D] = [this]() { this->ora(this->load_byte(this->addr_abs()), 4); };       /* ORA abs */
-    instruction_table[0x0E] = [this]() { this->asl_mem(this->addr_abs(), 6); };                    /* ASL abs */
-    instruction_table[0x0F] = [this]() { this->slo(this->addr_abs(), 3, 3); };                     /* SLO abs ~ Illegal OPCode */
-    /* 0x10 ~ 0x1F */
-    instruction_table[0x10] = [this]() { this->bpl(); };                                           /* BPL rel */
-    instruction_table[0x11] = [this]() { this->ora(this->load_byte(this->addr_indy()), 5); };      /* ORA (ind),Y */
-    instruction_table[0x12] = [this]() { this->jam(0x12); };                                       /* JAM ~ Illegal OPCode */
-    instruction_table[0x13] = [this]() { this->slo(this->addr_indy(), 5, 3); };                    /* SLO (ind),Y ~ Illegal OPCode */
-    instruction_table[0x14] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };     /* NOP zpg,X ~ Illegal OPCode */
-    instruction_table[0x15] = [this]() { this->ora(this->load_byte(this->addr_zerox()), 4); };     /* ORA zpg,X */
-    instruction_table[0x16] = [this]() { this->asl_mem(this->addr_zerox(), 6); };                  /* ASL zpg,X */
-    instruction_table[0x17] = [this]() { this->slo(this->addr_zerox(), 2, 3); };                   /* SLO zpg,X ~ Illegal OPCode */
-    instruction_table[0x18] = [this]() { this->clc(); };                                           /* CLC impl */
-    instruction_table[0x19] = [this]() { this->ora(this->load_byte(this->addr_absy()), 4); };      /* ORA abs,Y */
-    instruction_table[0x1A] = [this]() { this->nop(2); };                                          /* NOP impl ~ Illegal OPCode */
-    instruction_table[0x1B] = [this]() { this->slo(this->addr_absy(), 4, 2); };                    /* SLO abs,Y ~ Illegal OPCode */
-    instruction_table[0x1C] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };      /* NOP abs,X ~ Illegal OPCode */
-    instruction_table[0x1D] = [this]() { this->ora(this->load_byte(this->addr_absx()), 4); };      /* ORA abs,X */
-    instruction_table[0x1E] = [this]() { this->asl_mem(this->addr_absx(), 7); };                   /* ASL abs,X */
-    instruction_table[0x1F] = [this]() { this->slo(this->addr_absx(), 4, 2); };                    /* SLO abs,X ~ Illegal OPCode */
-    /* 0x20 ~ 0x2F */
-    instruction_table[0x20] = [this]() { this->jsr(); };                                           /* JSR abs */
-    instruction_table[0x21] = [this]() { this->_and(this->load_byte(this->addr_indx()), 6); };     /* AND (ind,X) */
-    instruction_table[0x22] = [this]() { this->jam(0x22); };                                       /* JAM ~ Illegal OPCode */
-    instruction_table[0x23] = [this]() { this->rla(this->addr_indx(), 5, 3); };                    /* RLA (ind,X) ~ Illegal OPCode */
-    instruction_table[0x24] = [this]() { this->bit(this->addr_zero(), 3); };                       /* BIT zpg */
-    instruction_table[0x25] = [this]() { this->_and(this->load_byte(this->addr_zero()), 3); };     /* AND zpg */
-    instruction_table[0x26] = [this]() { this->rol_mem(this->addr_zero(), 5); };                   /* ROL zpg */
-    instruction_table[0x27] = [this]() { this->rla(this->addr_zero(), 3, 2); };
-    instruction_table[0x28] = [this]() { this->plp(); };
-    instruction_table[0x29] = [this]() { this->_and(this->fetch_op(), 2); };
-    instruction_table[0x2A] = [this]() { this->rol_a(); };
-    instruction_table[0x2B] = [this]() { this->lxa(this->fetch_op(), 2); };
-    instruction_table[0x2C] = [this]() { this->bit(this->addr_abs(), 4); };
-    instruction_table[0x2D] = [this]() { this->_and(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0x2E] = [this]() { this->rol_mem(this->addr_abs(), 6); };
-    instruction_table[0x2F] = [this]() { this->rla_(this->addr_abs(), 4, 2); };                     /* RLA abs ~ Illegal OPCode */
-
-    instruction_table[0x30] = [this]() { this->bmi(); };
-    instruction_table[0x31] = [this]() { this->_and(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0x32] = [this]() { this->jam(0x32); };
-    instruction_table[0x33] = [this]() { this->rla(this->addr_indy(), 5, 3); };
-    instruction_table[0x34] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };
-    instruction_table[0x35] = [this]() { this->_and(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0x36] = [this]() { this->rol_mem(this->addr_zerox(), 6); };
-    instruction_table[0x37] = [this]() { this->rla(this->addr_zerox(), 4, 2); };
-    instruction_table[0x38] = [this]() { this->sec(); };
-    instruction_table[0x39] = [this]() { this->_and(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0x3A] = [this]() { this->nop(2); };
-    instruction_table[0x3B] = [this]() { this->rla(this->addr_absy(), 4, 2); };
-    instruction_table[0x3C] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };
-    instruction_table[0x3D] = [this]() { this->_and(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0x3E] = [this]() { this->rol_mem(this->addr_absx(), 7); };
-    instruction_table[0x3F] = [this]() { this->rla(this->addr_absx(), 4, 2); };
-
-    instruction_table[0x40] = [this]() { this->rti(); };
-    instruction_table[0x41] = [this]() { this->eor(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0x42] = [this]() { this->jam(0x42); };
-    instruction_table[0x43] = [this]() { this->sre(this->addr_indx(), 5, 3); };
-    instruction_table[0x44] = [this]() { this->load_byte(this->addr_zero()); this->nop(3); };
-    instruction_table[0x45] = [this]() { this->eor(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0x46] = [this]() { this->lsr_mem(this->addr_zero(), 5); };
-    instruction_table[0x47] = [this]() { this->sre(this->addr_zero(), 3, 2); };
-    instruction_table[0x48] = [this]() { this->pha(); };
-    instruction_table[0x49] = [this]() { this->eor(this->fetch_op(), 2); };
-    instruction_table[0x4A] = [this]() { this->lsr_a(); };
-    instruction_table[0x4B] = [this]() { this->_and(fetch_op(),0); this->lsr_a(); };
-    instruction_table[0x4C] = [this]() { this->jmp(); };
-    instruction_table[0x4D] = [this]() { this->eor(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0x4E] = [this]() { this->lsr_mem(this->addr_abs(), 6); };
-    instruction_table[0x4F] = [this]() { this->sre(this->addr_abs(), 4, 2); };
-
-    instruction_table[0x50] = [this]() { this->bvc(); };
-    instruction_table[0x51] = [this]() { this->eor(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0x52] = [this]() { this->jam(0x52); };
-    instruction_table[0x53] = [this]() { this->sre(this->addr_indy(), 5, 3); };
-    instruction_table[0x54] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };
-    instruction_table[0x55] = [this]() { this->eor(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0x56] = [this]() { this->lsr_mem(this->addr_zerox(), 6); };
-    instruction_table[0x57] = [this]() { this->sre(this->addr_zerox(), 4, 2); };
-    instruction_table[0x58] = [this]() { this->cli(); };
-    instruction_table[0x59] = [this]() { this->eor(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0x5A] = [this]() { this->nop(2); };
-    instruction_table[0x5B] = [this]() { this->sre(this->addr_absy(), 4, 2); };
-    instruction_table[0x5C] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };
-    instruction_table[0x5D] = [this]() { this->eor(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0x5E] = [this]() { this->lsr_mem(this->addr_absx(), 7); };
-    instruction_table[0x5F] = [this]() { this->sre(this->addr_absx(), 4, 2); };
-
-    instruction_table[0x60] = [this]() { this->rts(); };
-    instruction_table[0x61] = [this]() { this->adc(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0x62] = [this]() { this->jam(0x62); };
-    instruction_table[0x63] = [this]() { this->rra(this->addr_indx(), 5, 3); };
-    instruction_table[0x64] = [this]() { this->load_byte(this->addr_zero()); this->nop(3); };
-    instruction_table[0x65] = [this]() { this->adc(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0x66] = [this]() { this->ror_mem(this->addr_zero(), 5); };
-    instruction_table[0x67] = [this]() { this->rra(this->addr_zero(), 3, 2); };
-    instruction_table[0x68] = [this]() { this->pla(); };
-    instruction_table[0x69] = [this]() { this->adc(this->fetch_op(), 2); };
-    instruction_table[0x6A] = [this]() { this->ror_a(); };
-    instruction_table[0x6B] = [this]() { this->arr(); };
-    instruction_table[0x6C] = [this]() { this->jmp_ind(); };
-    instruction_table[0x6D] = [this]() { this->adc(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0x6E] = [this]() { this->ror_mem(this->addr_abs(), 6); };
-    instruction_table[0x6F] = [this]() { this->rra(this->addr_abs(), 4, 2); };
-
-    instruction_table[0x70] = [this]() { this->bvs(); };
-    instruction_table[0x71] = [this]() { this->adc(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0x72] = [this]() { this->jam(0x72); };
-    instruction_table[0x73] = [this]() { this->rra(this->addr_indy(), 5, 3); };
-    instruction_table[0x74] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };
-    instruction_table[0x75] = [this]() { this->adc(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0x76] = [this]() { this->ror_mem(this->addr_zerox(), 6); };
-    instruction_table[0x77] = [this]() { this->rra(this->addr_zerox(), 4, 2); };
-    instruction_table[0x78] = [this]() { this->sei(); };
-    instruction_table[0x79] = [this]() { this->adc(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0x7A] = [this]() { this->nop(2); };
-    instruction_table[0x7B] = [this]() { this->rra(this->addr_absy(), 4, 2); };
-    instruction_table[0x7C] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };
-    instruction_table[0x7D] = [this]() { this->adc(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0x7E] = [this]() { this->ror_mem(this->addr_absx(), 7); };
-    instruction_table[0x7F] = [this]() { this->rra(this->addr_absx(), 4, 2); };
-
-    instruction_table[0x80] = [this]() { this->fetch_op(); this->nop(2); };
-    instruction_table[0x81] = [this]() { this->sta(this->addr_indx(), 6); };
-    instruction_table[0x82] = [this]() { this->fetch_op(); this->nop(2); };
-    instruction_table[0x83] = [this]() { this->sax(this->addr_indx(), 3); };
-    instruction_table[0x84] = [this]() { this->sty(this->addr_zero(), 3); };
-    instruction_table[0x85] = [this]() { this->sta(this->addr_zero(), 3); };
-    instruction_table[0x86] = [this]() { this->stx(this->addr_zero(), 3); };
-    instruction_table[0x87] = [this]() { this->sax(this->addr_zero(), 3); };
-    instruction_table[0x88] = [this]() { this->dey(); };
-    instruction_table[0x89] = [this]() { this->fetch_op(); this->nop(2); };
-    instruction_table[0x8A] = [this]() { this->txa(); };
-    instruction_table[0x8B] = [this]() { this->tas(this->addr_abs(), 4); };
-    instruction_table[0x8C] = [this]() { this->sty(this->addr_abs(), 4); };
-    instruction_table[0x8D] = [this]() { this->sta(this->addr_abs(), 4); };
-    instruction_table[0x8E] = [this]() { this->stx(this->addr_abs(), 4); };
-    instruction_table[0x8F] = [this]() { this->sax(this->addr_abs(), 4); };
-
-    instruction_table[0x90] = [this]() { this->bcc(); };
-    instruction_table[0x91] = [this]() { this->sta(this->addr_indy(), 6); };
-    instruction_table[0x92] = [this]() { this->jam(0x92); };
-    instruction_table[0x93] = [this]() { this->sha(this->addr_indy(), 6); };
-    instruction_table[0x94] = [this]() { this->sty(this->addr_zerox(), 4); };
-    instruction_table[0x95] = [this]() { this->sta(this->addr_zerox(), 4); };
-    instruction_table[0x96] = [this]() { this->stx(this->addr_zeroy(), 4); };
-    instruction_table[0x97] = [this]() { this->sax(this->addr_zeroy(), 4); };
-    instruction_table[0x98] = [this]() { this->tya(); };
-    instruction_table[0x99] = [this]() { this->sta(this->addr_absy(), 5); };
-    instruction_table[0x9A] = [this]() { this->txs(); };
-    instruction_table[0x9B] = [this]() { this->tas(this->addr_absy(), 5); };
-    instruction_table[0x9C] = [this]() { this->shy(this->addr_absx(), 5); };
-    instruction_table[0x9D] = [this]() { this->sta(this->addr_absx(), 5); };
-    instruction_table[0x9E] = [this]() { this->shx(this->addr_absy(), 5); };
-    instruction_table[0x9F] = [this]() { this->sha(this->addr_absy(), 5); };
-
-    instruction_table[0xA0] = [this]() { this->ldy(this->fetch_op(), 2); };
-    instruction_table[0xA1] = [this]() { this->lda(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0xA2] = [this]() { this->ldx(this->fetch_op(), 2); };
-    instruction_table[0xA3] = [this]() { this->lax(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0xA4] = [this]() { this->ldy(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xA5] = [this]() { this->lda(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xA6] = [this]() { this->ldx(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xA7] = [this]() { this->lax(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xA8] = [this]() { this->tay(); };
-    instruction_table[0xA9] = [this]() { this->lda(this->fetch_op(), 2); };
-    instruction_table[0xAA] = [this]() { this->tax(); };
-    instruction_table[0xAB] = [this]() { this->lxa(this->fetch_op(), 2); };
-    instruction_table[0xAC] = [this]() { this->ldy(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xAD] = [this]() { this->lda(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xAE] = [this]() { this->ldx(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xAF] = [this]() { this->lax(this->load_byte(this->addr_abs()), 4); };
-
-    instruction_table[0xB0] = [this]() { this->bcs(); };
-    instruction_table[0xB1] = [this]() { this->lda(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0xB2] = [this]() { this->jam(0xB2); };
-    instruction_table[0xB3] = [this]() { this->lax(this->load_byte(this->addr_indy()), 4); };
-    instruction_table[0xB4] = [this]() { this->ldy(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0xB5] = [this]() { this->lda(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0xB6] = [this]() { this->ldx(this->load_byte(this->addr_zeroy()), 4); };
-    instruction_table[0xB7] = [this]() { this->lax(this->load_byte(this->addr_zeroy()), 4); };
-    instruction_table[0xB8] = [this]() { this->clv(); };
-    instruction_table[0xB9] = [this]() { this->lda(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0xBA] = [this]() { this->tsx(); };
-    instruction_table[0xBB] = [this]() { this->las(this->load_byte(this->addr_absy())); };
-    instruction_table[0xBC] = [this]() { this->ldy(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0xBD] = [this]() { this->lda(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0xBE] = [this]() { this->ldx(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0xBF] = [this]() { this->lax(this->load_byte(this->addr_absy()), 4); };
-
-    instruction_table[0xC0] = [this]() { this->cpy(this->fetch_op(), 2); };
-    instruction_table[0xC1] = [this]() { this->cmp(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0xC2] = [this]() { this->fetch_op(); this->nop(2); };
-    instruction_table[0xC3] = [this]() { this->dcp(this->addr_indx(), 5, 3); };
-    instruction_table[0xC4] = [this]() { this->cpy(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xC5] = [this]() { this->cmp(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xC6] = [this]() { this->dec(this->addr_zero(), 5); };
-    instruction_table[0xC7] = [this]() { this->dcp(this->addr_zero(), 3, 2); };
-    instruction_table[0xC8] = [this]() { this->iny(); };
-    instruction_table[0xC9] = [this]() { this->cmp(this->fetch_op(), 2); };
-    instruction_table[0xCA] = [this]() { this->dex(); };
-    instruction_table[0xCB] = [this]() { this->sbx(this->fetch_op(), 2); };
-    instruction_table[0xCC] = [this]() { this->cpy(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xCD] = [this]() { this->cmp(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xCE] = [this]() { this->dec(this->addr_abs(), 6); };
-    instruction_table[0xCF] = [this]() { this->dcp(this->addr_abs(), 4, 2); };
-
-    instruction_table[0xD0] = [this]() { this->bne(); };
-    instruction_table[0xD1] = [this]() { this->cmp(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0xD2] = [this]() { this->jam(0xD2); };
-    instruction_table[0xD3] = [this]() { this->dcp(this->addr_indy(), 5, 3); };
-    instruction_table[0xD4] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };
-    instruction_table[0xD5] = [this]() { this->cmp(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0xD6] = [this]() { this->dec(this->addr_zerox(), 6); };
-    instruction_table[0xD7] = [this]() { this->dcp(this->addr_zerox(), 4, 2); };
-    instruction_table[0xD8] = [this]() { this->cld(); };
-    instruction_table[0xD9] = [this]() { this->cmp(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0xDA] = [this]() { this->nop(2); };
-    instruction_table[0xDB] = [this]() { this->dcp(this->addr_absy(), 4, 2); };
-    instruction_table[0xDC] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };
-    instruction_table[0xDD] = [this]() { this->cmp(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0xDE] = [this]() { this->dec(this->addr_absx(), 7); };
-    instruction_table[0xDF] = [this]() { this->dcp(this->addr_absx(), 5, 2); };
-
-    instruction_table[0xE0] = [this]() { this->cpx(this->fetch_op(), 2); };
-    instruction_table[0xE1] = [this]() { this->sbc(this->load_byte(this->addr_indx()), 6); };
-    instruction_table[0xE2] = [this]() { this->fetch_op(); this->nop(2); };
-    instruction_table[0xE3] = [this]() { this->isc(this->addr_indx(), 8); };
-    instruction_table[0xE4] = [this]() { this->cpx(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xE5] = [this]() { this->sbc(this->load_byte(this->addr_zero()), 3); };
-    instruction_table[0xE6] = [this]() { this->inc(this->addr_zero(), 5); };
-    instruction_table[0xE7] = [this]() { this->isc(this->addr_zero(), 5); };
-    instruction_table[0xE8] = [this]() { this->inx(); };
-    instruction_table[0xE9] = [this]() { this->sbc(this->fetch_op(), 2); };
-    instruction_table[0xEA] = [this]() { this->nop(2); };
-    instruction_table[0xEB] = [this]() { this->sbc(this->fetch_op(), 2); };
-    instruction_table[0xEC] = [this]() { this->cpx(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xED] = [this]() { this->sbc(this->load_byte(this->addr_abs()), 4); };
-    instruction_table[0xEE] = [this]() { this->inc(this->addr_abs(), 6); };
-    instruction_table[0xEF] = [this]() { this->isc(this->addr_abs(), 6); };
-
-    instruction_table[0xF0] = [this]() { this->beq(); };
-    instruction_table[0xF1] = [this]() { this->sbc(this->load_byte(this->addr_indy()), 5); };
-    instruction_table[0xF2] = [this]() { this->jam(0xF2); };
-    instruction_table[0xF3] = [this]() { this->isc(this->addr_indy(), 8); };
-    instruction_table[0xF4] = [this]() { this->load_byte(this->addr_zerox()); this->nop(4); };
-    instruction_table[0xF5] = [this]() { this->sbc(this->load_byte(this->addr_zerox()), 4); };
-    instruction_table[0xF6] = [this]() { this->inc(this->addr_zerox(), 6); };
-    instruction_table[0xF7] = [this]() { this->isc(this->addr_zerox(), 6); };
-    instruction_table[0xF8] = [this]() { this->sed(); };
-    instruction_table[0xF9] = [this]() { this->sbc(this->load_byte(this->addr_absy()), 4); };
-    instruction_table[0xFA] = [this]() { this->nop(2); };
-    instruction_table[0xFB] = [this]() { this->isc(this->addr_absy(), 6); };
-    instruction_table[0xFC] = [this]() { this->load_byte(this->addr_absx()); this->nop(4); };
-    instruction_table[0xFD] = [this]() { this->sbc(this->load_byte(this->addr_absx()), 4); };
-    instruction_table[0xFE] = [this]() { this->inc(this->addr_absx(), 7); };
-    instruction_table[0xFF] = [this]() { this->isc(this->addr_absx(), 7); };
-  }
-  return;
-}
-
-/**
- * @brief Execute an opcode by instruction number
- *
- * @param opcode
- */
-void __us_not_in_flash_func(execute) mos6510::execute(uint8_t opcode)
-{
-  auto& handler = instruction_table[opcode];
-
-  if (handler) { /* Check if the std::function has a target */
-    handler();
-  } else { /* Handle unknown opcode (e.g., log an error or throw a custom exception) */
-#if DESKTOP
-    std::cerr << "Error: Unimplemented opcode " << (int)opcode << std::endl;
-#endif
-  }
-  return;
-}
-
 CPUCLOCK __us_not_in_flash_func(cycles) mos6510::cycles(void)
 {
   return cycles_;
@@ -473,10 +176,26 @@ void mos6510::set_cycle_callback(ClockCycle c)
  * @brief emulate a single instruction
  * @return returns false if something goes wrong
  *
+ * Picks the traced or the plain instantiation of step on every
+ * call, emulation loops should select one once and call it directly
+ */
+bool __us_not_in_flash_func(emulate) mos6510::emulate(void)
+{
+  return (loginstructions ? step<trace_on>() : step<trace_off>());
+}
+
+/**
+ * @brief emulate a single instruction
+ * @return returns false if something goes wrong
+ *
+ * With trace_off no log checks or debug bookkeeping are compiled
+ * in, trace_on logs every instruction and skips no idle loops.
+ *
  * Current limitations:
  * - Some known cpu bugs are not emulated (correctly)
  */
-bool __us_not_in_flash_func(emulate) mos6510::emulate(void)
+template<class Trace>
+bool __us_not_in_flash_func(step) mos6510::step(void)
 {
   bool retval = true;
 
@@ -485,14 +204,23 @@ bool __us_not_in_flash_func(emulate) mos6510::emulate(void)
   /* VICII stalled the CPU for sprite handling, do nothing */
   // if (vic_stall_cpu_) { tick(1); return retval; };
 
+  /* Parked in an idle loop, skip ahead to the next interrupt */
+  if constexpr (!Trace::enabled) {
+    if _MOS_UNLIKELY (idle_loop_ && pc_ == idle_pc_ && idle_skip()) { return retval; }
+  }
+
   /* fetch instruction */
+  if (predecode_enabled) { ibuf_ = predecode(pc_); }
+  if constexpr (Trace::enabled) { pc_address = pc_; }
   val_t insn = fetch_op();
   pb_crossed = false;
+  if constexpr (Trace::enabled) { d_address = trace_address(insn); }
 
   /* execute instruction */
   execute(insn);
+  ibuf_ = nullptr;
 
-  if (loginstructions) { dump_regs_insn(insn); }
+  if constexpr (Trace::enabled) { dump_regs_insn(insn); }
 
   /* Save state */
   last_insn = insn;
@@ -504,6 +232,9 @@ bool __us_not_in_flash_func(emulate) mos6510::emulate(void)
   return retval;
 }
 
+template bool mos6510::step<trace_off>(void);
+template bool mos6510::step<trace_on>(void);
+
 /**
  * @brief emulate N cpu instructions
  * @brief Or emulate until a RTI occurs
@@ -518,7 +249,8 @@ bool __us_not_in_flash_func(emulate_n) mos6510::emulate_n(tick_t n_cycles)
   CPUCLOCK end = (cycles() + n_cycles);
 
   for (;;) {
-    retval = emulate();
+    if (loginstructions) retval = step<trace_on>();
+    else retval = (superblocks_enabled ? emulate_block() : step<trace_off>());
 
     if (n_cycles == 0) {
       if (last_insn == 0x40) {
@@ -539,67 +271,197 @@ bool __us_not_in_flash_func(emulate_n) mos6510::emulate_n(tick_t n_cycles)
  * @param addr
  * @param val
  */
-void __us_not_in_flash_func(save_byte) mos6510::save_byte(addr_t addr, val_t val)
+_MOS_INLINE void __us_not_in_flash_func(save_byte) mos6510::save_byte(addr_t addr, val_t val)
 {
-  d_address = addr;
+  /* zero page and stack are always RAM */
+  if _MOS_LIKELY ((addr_t)(addr - 2) < ram_span_) {
+    ram_[addr] = val;
+    mmu_->mark_dirty(addr);
+    predecode_invalidate(addr);
+    return;
+  }
   write_bus(addr,val);
 }
 
-val_t __us_not_in_flash_func(load_byte) mos6510::load_byte(addr_t addr)
+_MOS_INLINE val_t __us_not_in_flash_func(load_byte) mos6510::load_byte(addr_t addr)
 {
-  d_address = addr;
+  if _MOS_LIKELY ((addr_t)(addr - 2) < ram_span_) {
+    return ram_[addr];
+  }
   return read_bus(addr);
 }
 
-addr_t __us_not_in_flash_func(load_word) mos6510::load_word(addr_t addr)
+/**
+ * @brief True if a fetch from addr always reads RAM
+ *
+ * Without cartridge support everything below the Basic ROM
+ * and $c000/$cfff can't be banked out, reads from $00/$01
+ * return RAM as well
+ */
+_MOS_INLINE bool __us_not_in_flash_func(ram_fetch) mos6510::ram_fetch(addr_t addr)
+{
+  return (ram_span_ && (addr < pAddrBasicFirstPage || (addr & 0xf000) == 0xc000));
+}
+
+_MOS_INLINE val_t __us_not_in_flash_func(fetch_byte) mos6510::fetch_byte(addr_t addr)
 {
-  addr_t v = load_byte(addr) | (load_byte(addr+1) << 8);
-  d_address = addr;
-  return v;
+  return (ram_fetch(addr) ? ram_[addr] : read_bus(addr));
 }
 
-void __us_not_in_flash_func(push) mos6510::push(val_t v)
+_MOS_INLINE addr_t __us_not_in_flash_func(load_word) mos6510::load_word(addr_t addr)
+{
+  return (load_byte(addr) | (load_byte(addr+1) << 8));
+}
+
+_MOS_INLINE void __us_not_in_flash_func(push) mos6510::push(val_t v)
 {
   addr_t addr = pBaseAddrStack+sp_;
   save_byte(addr,v);
   sp_--;
 }
 
-val_t __us_not_in_flash_func(pop) mos6510::pop()
+_MOS_INLINE val_t __us_not_in_flash_func(pop) mos6510::pop()
 {
   addr_t addr = ++sp_+pBaseAddrStack;
   return load_byte(addr);
 }
 
-val_t __us_not_in_flash_func(fetch_op) mos6510::fetch_op()
+_MOS_INLINE val_t __us_not_in_flash_func(fetch_op) mos6510::fetch_op()
 {
-  pc_address = pc_;
-  uint_least8_t op = load_byte(pc_++);
+  if (ibuf_) {
+    pc_++;
+    return *ibuf_++;
+  }
+  uint_least8_t op = fetch_byte(pc_++);
   return op;
 }
 
-addr_t __us_not_in_flash_func(fetch_opw) mos6510::fetch_opw()
+_MOS_INLINE addr_t __us_not_in_flash_func(fetch_opw) mos6510::fetch_opw()
 {
-  addr_t retval = load_word(pc_);
+  addr_t retval;
+  if (ibuf_) {
+    retval = (ibuf_[0] | (ibuf_[1] << 8));
+    ibuf_ += 2;
+  } else {
+    retval = (fetch_byte(pc_) | (fetch_byte(pc_+1) << 8));
+  }
   pc_+=2;
-  pc_address = pc_;
   return retval;
 }
 
-addr_t __us_not_in_flash_func(addr_zero) mos6510::addr_zero()
+/* Predecode cache */
+
+/**
+ * @brief Returns the predecoded opcode and operand bytes at addr
+ * or nullptr if the instruction cannot be cached
+ *
+ * Instructions in the IO pages are never cached since fetching
+ * from there can have side effects, neither are instructions
+ * at the last two bytes of a page so an entry never depends on
+ * more than the page it lives in.
+ */
+_MOS_INLINE const val_t * __us_not_in_flash_func(predecode) mos6510::predecode(addr_t addr)
+{
+  val_t page = (addr >> 8), offset = (addr & 0xff);
+  if _MOS_UNLIKELY((page >= 0xd0 && page <= 0xdf) || offset >= 0xfe) {
+    return nullptr;
+  }
+  predecode_page_t * p = predecode_[page];
+  if _MOS_UNLIKELY(p == nullptr) {
+    p = predecode_[page] = new predecode_page_t();
+  }
+  val_t * insn = p->insn[offset];
+  uint64_t bit = (1ULL << (offset & 0x3f));
+  if _MOS_LIKELY(p->valid[offset >> 6] & bit) {
+    predecode_stats_.hits++;
+    return insn;
+  }
+  predecode_stats_.misses++;
+  insn[0] = fetch_byte(addr);
+  for (int i = 1; i < mos6510_opcodes[insn[0]].length; i++) {
+    insn[i] = fetch_byte(addr + i);
+  }
+  p->valid[offset >> 6] |= bit;
+  return insn;
+}
+
+/**
+ * @brief Drop cached instructions and superblocks that include
+ * the byte at addr
+ *
+ * Called by the MMU on every write to RAM, the write only touches
+ * the instructions starting at most two bytes before addr
+ */
+void __us_not_in_flash_func(predecode_invalidate) mos6510::predecode_invalidate(addr_t addr)
+{
+  val_t page = (addr >> 8);
+  if _MOS_UNLIKELY(superblock_code_[page][(addr & 0xff) >> 6] & (1ULL << (addr & 0x3f))) {
+    superblock_gen_[page]++;
+    memset(superblock_code_[page], 0, sizeof(superblock_code_[page]));
+    superblock_invalidations_++;
+    superblock_stats_.invalidations++;
+  }
+  predecode_page_t * p = predecode_[page];
+  if _MOS_LIKELY(p == nullptr) return;
+  bool dropped = false;
+  for (int offset = (addr & 0xff); offset >= 0 && offset > ((addr & 0xff) - 3); offset--) {
+    uint64_t bit = (1ULL << (offset & 0x3f));
+    if (p->valid[offset >> 6] & bit) {
+      p->valid[offset >> 6] &= ~bit;
+      dropped = true;
+    }
+  }
+  if (dropped) predecode_stats_.invalidations++;
+}
+
+/**
+ * @brief Drop all cached instructions in a range of pages
+ *
+ * Used when the memory layout changes underneath cached pages
+ */
+void __us_not_in_flash_func(predecode_flush) mos6510::predecode_flush(val_t first_page, val_t last_page)
+{
+  for (int page = first_page; page <= last_page; page++) {
+    if (predecode_[page] != nullptr) {
+      memset(predecode_[page]->valid, 0, sizeof(predecode_[page]->valid));
+    }
+    superblock_gen_[page]++;
+    memset(superblock_code_[page], 0, sizeof(superblock_code_[page]));
+  }
+  superblock_invalidations_++;
+  predecode_stats_.flushes++;
+}
+
+void mos6510::dump_predecode_stats(void)
+{
+  uint64_t total = (predecode_stats_.hits + predecode_stats_.misses);
+  int pages = 0;
+  for (size_t i = 0; i < count_of(predecode_); i++) {
+    if (predecode_[i] != nullptr) pages++;
+  }
+  MOSDBG("[CPU] Predecode hits: %llu misses: %llu (%.2f%% hit rate) invalidations: %llu flushes: %llu pages: %d\n",
+    (unsigned long long)predecode_stats_.hits,
+    (unsigned long long)predecode_stats_.misses,
+    (total ? (100.0 * predecode_stats_.hits / total) : 0.0),
+    (unsigned long long)predecode_stats_.invalidations,
+    (unsigned long long)predecode_stats_.flushes,
+    pages);
+}
+
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_zero) mos6510::addr_zero()
 {
   addr_t addr = fetch_op();
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_zerox) mos6510::addr_zerox()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_zerox) mos6510::addr_zerox()
 {
   /* wraps around the zeropage */
   addr_t addr = (fetch_op() + x()) & 0xff;
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_zeroy) mos6510::addr_zeroy()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_zeroy) mos6510::addr_zeroy()
 {
   /* wraps around the zeropage */
   addr_t addr = (fetch_op() + y()) & 0xff;
@@ -607,76 +469,693 @@ addr_t __us_not_in_flash_func(addr_zeroy) mos6510::addr_zeroy()
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_abs) mos6510::addr_abs()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_abs) mos6510::addr_abs()
 {
   addr_t addr = fetch_opw();
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_absy) mos6510::addr_absy()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_absy) mos6510::addr_absy()
 {
   addr_t addr = fetch_opw();
   curr_page = addr&0xff00;
   addr += y();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
+  if ((addr&0xff00)!=curr_page) pb_crossed = true;
 
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_absx) mos6510::addr_absx()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_absx) mos6510::addr_absx()
 {
   addr_t addr = fetch_opw();
   curr_page = addr&0xff00;
   addr += x();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
+  if ((addr&0xff00)!=curr_page) pb_crossed = true;
 
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_indx) mos6510::addr_indx()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_indx) mos6510::addr_indx()
 {
   /* wraps around the zeropage */
   addr_t addr = load_word((addr_zero() + x()) & 0xff);
   return addr;
 }
 
-addr_t __us_not_in_flash_func(addr_indy) mos6510::addr_indy()
+_MOS_INLINE addr_t __us_not_in_flash_func(addr_indy) mos6510::addr_indy()
 {
   addr_t addr = load_word(addr_zero());
   curr_page = addr&0xff00;
   addr += y();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
+  if ((addr&0xff00)!=curr_page) pb_crossed = true;
 
   return addr;
 }
 
+/**
+ * @brief Effective address of an opcode, the addressing
+ * mode is resolved from the opcode table at compile time
+ */
+template<val_t op>
+_MOS_INLINE addr_t mos6510::ea(void)
+{
+  constexpr AddrMode mode = mos6510_opcodes[op].mode;
+  if constexpr (mode == kZeroPage) {
+    return addr_zero();
+  } else if constexpr (mode == kZeroPageX) {
+    return addr_zerox();
+  } else if constexpr (mode == kZeroPageY) {
+    return addr_zeroy();
+  } else if constexpr (mode == kAbsolute) {
+    return addr_abs();
+  } else if constexpr (mode == kAbsoluteX) {
+    return addr_absx();
+  } else if constexpr (mode == kAbsoluteY) {
+    return addr_absy();
+  } else if constexpr (mode == kIndirectX) {
+    return addr_indx();
+  } else {
+    static_assert(mode == kIndirectY, "opcode has no effective address");
+    return addr_indy();
+  }
+}
+
+/**
+ * @brief Operand value of an opcode, either the immediate
+ * byte or the value read from the effective address
+ */
+template<val_t op>
+_MOS_INLINE val_t mos6510::operand(void)
+{
+  if constexpr (mos6510_opcodes[op].mode == kImmediate) {
+    return fetch_op();
+  } else {
+    return load_byte(ea<op>());
+  }
+}
+
+/**
+ * @brief Run the handler for an opcode without clocking
+ *
+ * Dispatch is a plain switch over all 256 opcodes so the
+ * compiler can build a jump table and inline the handlers,
+ * operand addressing and cycle counts come from the opcode table.
+ * Called with a constant opcode the switch folds down to a
+ * single handler, see superblock_handler
+ *
+ * @param opcode
+ */
+_MOS_INLINE void __us_not_in_flash_func(dispatch) mos6510::dispatch(val_t opcode)
+{
+  switch (opcode) {
+    /* 0x00 ~ 0x0F */
+    case 0x00: brk(); break;                            /* BRK impl */
+    case 0x01: ora(operand<0x01>()); break;             /* ORA X,ind */
+    case 0x02: jam(0x02); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x03: slo(ea<0x03>()); break;                  /* SLO X,ind ~ Illegal OPCode */
+    case 0x04: operand<0x04>(); break;                  /* NOP zpg ~ Illegal OPCode */
+    case 0x05: ora(operand<0x05>()); break;             /* ORA zpg */
+    case 0x06: asl_mem(ea<0x06>()); break;              /* ASL zpg */
+    case 0x07: slo(ea<0x07>()); break;                  /* SLO zpg ~ Illegal OPCode */
+    case 0x08: php(); break;                            /* PHP impl */
+    case 0x09: ora(operand<0x09>()); break;             /* ORA # */
+    case 0x0A: asl_a(); break;                          /* ASL A */
+    case 0x0B: anc(operand<0x0B>()); break;             /* ANC # ~ Illegal OPCode */
+    case 0x0C: operand<0x0C>(); break;                  /* NOP abs ~ Illegal OPCode */
+    case 0x0D: ora(operand<0x0D>()); break;             /* ORA abs */
+    case 0x0E: asl_mem(ea<0x0E>()); break;              /* ASL abs */
+    case 0x0F: slo(ea<0x0F>()); break;                  /* SLO abs ~ Illegal OPCode */
+    /* 0x10 ~ 0x1F */
+    case 0x10: branch(!nf()); break;                    /* BPL rel */
+    case 0x11: ora(operand<0x11>()); break;             /* ORA ind,Y */
+    case 0x12: jam(0x12); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x13: slo(ea<0x13>()); break;                  /* SLO ind,Y ~ Illegal OPCode */
+    case 0x14: operand<0x14>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0x15: ora(operand<0x15>()); break;             /* ORA zpg,X */
+    case 0x16: asl_mem(ea<0x16>()); break;              /* ASL zpg,X */
+    case 0x17: slo(ea<0x17>()); break;                  /* SLO zpg,X ~ Illegal OPCode */
+    case 0x18: clc(); break;                            /* CLC impl */
+    case 0x19: ora(operand<0x19>()); break;             /* ORA abs,Y */
+    case 0x1A: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0x1B: slo(ea<0x1B>()); break;                  /* SLO abs,Y ~ Illegal OPCode */
+    case 0x1C: operand<0x1C>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0x1D: ora(operand<0x1D>()); break;             /* ORA abs,X */
+    case 0x1E: asl_mem(ea<0x1E>()); break;              /* ASL abs,X */
+    case 0x1F: slo(ea<0x1F>()); break;                  /* SLO abs,X ~ Illegal OPCode */
+    /* 0x20 ~ 0x2F */
+    case 0x20: jsr(); break;                            /* JSR abs */
+    case 0x21: _and(operand<0x21>()); break;            /* AND X,ind */
+    case 0x22: jam(0x22); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x23: rla(ea<0x23>()); break;                  /* RLA X,ind ~ Illegal OPCode */
+    case 0x24: bit(ea<0x24>()); break;                  /* BIT zpg */
+    case 0x25: _and(operand<0x25>()); break;            /* AND zpg */
+    case 0x26: rol_mem(ea<0x26>()); break;              /* ROL zpg */
+    case 0x27: rla(ea<0x27>()); break;                  /* RLA zpg ~ Illegal OPCode */
+    case 0x28: plp(); break;                            /* PLP impl */
+    case 0x29: _and(operand<0x29>()); break;            /* AND # */
+    case 0x2A: rol_a(); break;                          /* ROL A */
+    case 0x2B: anc(operand<0x2B>()); break;             /* ANC # ~ Illegal OPCode */
+    case 0x2C: bit(ea<0x2C>()); break;                  /* BIT abs */
+    case 0x2D: _and(operand<0x2D>()); break;            /* AND abs */
+    case 0x2E: rol_mem(ea<0x2E>()); break;              /* ROL abs */
+    case 0x2F: rla(ea<0x2F>()); break;                  /* RLA abs ~ Illegal OPCode */
+    /* 0x30 ~ 0x3F */
+    case 0x30: branch(nf()); break;                     /* BMI rel */
+    case 0x31: _and(operand<0x31>()); break;            /* AND ind,Y */
+    case 0x32: jam(0x32); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x33: rla(ea<0x33>()); break;                  /* RLA ind,Y ~ Illegal OPCode */
+    case 0x34: operand<0x34>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0x35: _and(operand<0x35>()); break;            /* AND zpg,X */
+    case 0x36: rol_mem(ea<0x36>()); break;              /* ROL zpg,X */
+    case 0x37: rla(ea<0x37>()); break;                  /* RLA zpg,X ~ Illegal OPCode */
+    case 0x38: sec(); break;                            /* SEC impl */
+    case 0x39: _and(operand<0x39>()); break;            /* AND abs,Y */
+    case 0x3A: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0x3B: rla(ea<0x3B>()); break;                  /* RLA abs,Y ~ Illegal OPCode */
+    case 0x3C: operand<0x3C>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0x3D: _and(operand<0x3D>()); break;            /* AND abs,X */
+    case 0x3E: rol_mem(ea<0x3E>()); break;              /* ROL abs,X */
+    case 0x3F: rla(ea<0x3F>()); break;                  /* RLA abs,X ~ Illegal OPCode */
+    /* 0x40 ~ 0x4F */
+    case 0x40: rti(); break;                            /* RTI impl */
+    case 0x41: eor(operand<0x41>()); break;             /* EOR X,ind */
+    case 0x42: jam(0x42); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x43: sre(ea<0x43>()); break;                  /* SRE X,ind ~ Illegal OPCode */
+    case 0x44: operand<0x44>(); break;                  /* NOP zpg ~ Illegal OPCode */
+    case 0x45: eor(operand<0x45>()); break;             /* EOR zpg */
+    case 0x46: lsr_mem(ea<0x46>()); break;              /* LSR zpg */
+    case 0x47: sre(ea<0x47>()); break;                  /* SRE zpg ~ Illegal OPCode */
+    case 0x48: pha(); break;                            /* PHA impl */
+    case 0x49: eor(operand<0x49>()); break;             /* EOR # */
+    case 0x4A: lsr_a(); break;                          /* LSR A */
+    case 0x4B: _and(operand<0x4B>()); lsr_a(); break;   /* ALR # ~ Illegal OPCode */
+    case 0x4C: jmp(); break;                            /* JMP abs */
+    case 0x4D: eor(operand<0x4D>()); break;             /* EOR abs */
+    case 0x4E: lsr_mem(ea<0x4E>()); break;              /* LSR abs */
+    case 0x4F: sre(ea<0x4F>()); break;                  /* SRE abs ~ Illegal OPCode */
+    /* 0x50 ~ 0x5F */
+    case 0x50: branch(!of()); break;                    /* BVC rel */
+    case 0x51: eor(operand<0x51>()); break;             /* EOR ind,Y */
+    case 0x52: jam(0x52); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x53: sre(ea<0x53>()); break;                  /* SRE ind,Y ~ Illegal OPCode */
+    case 0x54: operand<0x54>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0x55: eor(operand<0x55>()); break;             /* EOR zpg,X */
+    case 0x56: lsr_mem(ea<0x56>()); break;              /* LSR zpg,X */
+    case 0x57: sre(ea<0x57>()); break;                  /* SRE zpg,X ~ Illegal OPCode */
+    case 0x58: cli(); break;                            /* CLI impl */
+    case 0x59: eor(operand<0x59>()); break;             /* EOR abs,Y */
+    case 0x5A: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0x5B: sre(ea<0x5B>()); break;                  /* SRE abs,Y ~ Illegal OPCode */
+    case 0x5C: operand<0x5C>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0x5D: eor(operand<0x5D>()); break;             /* EOR abs,X */
+    case 0x5E: lsr_mem(ea<0x5E>()); break;              /* LSR abs,X */
+    case 0x5F: sre(ea<0x5F>()); break;                  /* SRE abs,X ~ Illegal OPCode */
+    /* 0x60 ~ 0x6F */
+    case 0x60: rts(); break;                            /* RTS impl */
+    case 0x61: adc(operand<0x61>()); break;             /* ADC X,ind */
+    case 0x62: jam(0x62); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x63: rra(ea<0x63>()); break;                  /* RRA X,ind ~ Illegal OPCode */
+    case 0x64: operand<0x64>(); break;                  /* NOP zpg ~ Illegal OPCode */
+    case 0x65: adc(operand<0x65>()); break;             /* ADC zpg */
+    case 0x66: ror_mem(ea<0x66>()); break;              /* ROR zpg */
+    case 0x67: rra(ea<0x67>()); break;                  /* RRA zpg ~ Illegal OPCode */
+    case 0x68: pla(); break;                            /* PLA impl */
+    case 0x69: adc(operand<0x69>()); break;             /* ADC # */
+    case 0x6A: ror_a(); break;                          /* ROR A */
+    case 0x6B: arr(operand<0x6B>()); break;             /* ARR # ~ Illegal OPCode */
+    case 0x6C: jmp_ind(); break;                        /* JMP ind */
+    case 0x6D: adc(operand<0x6D>()); break;             /* ADC abs */
+    case 0x6E: ror_mem(ea<0x6E>()); break;              /* ROR abs */
+    case 0x6F: rra(ea<0x6F>()); break;                  /* RRA abs ~ Illegal OPCode */
+    /* 0x70 ~ 0x7F */
+    case 0x70: branch(of()); break;                     /* BVS rel */
+    case 0x71: adc(operand<0x71>()); break;             /* ADC ind,Y */
+    case 0x72: jam(0x72); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x73: rra(ea<0x73>()); break;                  /* RRA ind,Y ~ Illegal OPCode */
+    case 0x74: operand<0x74>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0x75: adc(operand<0x75>()); break;             /* ADC zpg,X */
+    case 0x76: ror_mem(ea<0x76>()); break;              /* ROR zpg,X */
+    case 0x77: rra(ea<0x77>()); break;                  /* RRA zpg,X ~ Illegal OPCode */
+    case 0x78: sei(); break;                            /* SEI impl */
+    case 0x79: adc(operand<0x79>()); break;             /* ADC abs,Y */
+    case 0x7A: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0x7B: rra(ea<0x7B>()); break;                  /* RRA abs,Y ~ Illegal OPCode */
+    case 0x7C: operand<0x7C>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0x7D: adc(operand<0x7D>()); break;             /* ADC abs,X */
+    case 0x7E: ror_mem(ea<0x7E>()); break;              /* ROR abs,X */
+    case 0x7F: rra(ea<0x7F>()); break;                  /* RRA abs,X ~ Illegal OPCode */
+    /* 0x80 ~ 0x8F */
+    case 0x80: operand<0x80>(); break;                  /* NOP # ~ Illegal OPCode */
+    case 0x81: sta(ea<0x81>()); break;                  /* STA X,ind */
+    case 0x82: operand<0x82>(); break;                  /* NOP # ~ Illegal OPCode */
+    case 0x83: sax(ea<0x83>()); break;                  /* SAX X,ind ~ Illegal OPCode */
+    case 0x84: sty(ea<0x84>()); break;                  /* STY zpg */
+    case 0x85: sta(ea<0x85>()); break;                  /* STA zpg */
+    case 0x86: stx(ea<0x86>()); break;                  /* STX zpg */
+    case 0x87: sax(ea<0x87>()); break;                  /* SAX zpg ~ Illegal OPCode */
+    case 0x88: dey(); break;                            /* DEY impl */
+    case 0x89: operand<0x89>(); break;                  /* NOP # ~ Illegal OPCode */
+    case 0x8A: txa(); break;                            /* TXA impl */
+    case 0x8B: xaa(operand<0x8B>()); break;             /* ANE # ~ Illegal OPCode */
+    case 0x8C: sty(ea<0x8C>()); break;                  /* STY abs */
+    case 0x8D: sta(ea<0x8D>()); break;                  /* STA abs */
+    case 0x8E: stx(ea<0x8E>()); break;                  /* STX abs */
+    case 0x8F: sax(ea<0x8F>()); break;                  /* SAX abs ~ Illegal OPCode */
+    /* 0x90 ~ 0x9F */
+    case 0x90: branch(!cf()); break;                    /* BCC rel */
+    case 0x91: sta(ea<0x91>()); break;                  /* STA ind,Y */
+    case 0x92: jam(0x92); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0x93: sha(ea<0x93>()); break;                  /* SHA ind,Y ~ Illegal OPCode */
+    case 0x94: sty(ea<0x94>()); break;                  /* STY zpg,X */
+    case 0x95: sta(ea<0x95>()); break;                  /* STA zpg,X */
+    case 0x96: stx(ea<0x96>()); break;                  /* STX zpg,Y */
+    case 0x97: sax(ea<0x97>()); break;                  /* SAX zpg,Y ~ Illegal OPCode */
+    case 0x98: tya(); break;                            /* TYA impl */
+    case 0x99: sta(ea<0x99>()); break;                  /* STA abs,Y */
+    case 0x9A: txs(); break;                            /* TXS impl */
+    case 0x9B: tas(ea<0x9B>()); break;                  /* TAS abs,Y ~ Illegal OPCode */
+    case 0x9C: shy(ea<0x9C>()); break;                  /* SHY abs,X ~ Illegal OPCode */
+    case 0x9D: sta(ea<0x9D>()); break;                  /* STA abs,X */
+    case 0x9E: shx(ea<0x9E>()); break;                  /* SHX abs,Y ~ Illegal OPCode */
+    case 0x9F: sha(ea<0x9F>()); break;                  /* SHA abs,Y ~ Illegal OPCode */
+    /* 0xA0 ~ 0xAF */
+    case 0xA0: ldy(operand<0xA0>()); break;             /* LDY # */
+    case 0xA1: lda(operand<0xA1>()); break;             /* LDA X,ind */
+    case 0xA2: ldx(operand<0xA2>()); break;             /* LDX # */
+    case 0xA3: lax(operand<0xA3>()); break;             /* LAX X,ind ~ Illegal OPCode */
+    case 0xA4: ldy(operand<0xA4>()); break;             /* LDY zpg */
+    case 0xA5: lda(operand<0xA5>()); break;             /* LDA zpg */
+    case 0xA6: ldx(operand<0xA6>()); break;             /* LDX zpg */
+    case 0xA7: lax(operand<0xA7>()); break;             /* LAX zpg ~ Illegal OPCode */
+    case 0xA8: tay(); break;                            /* TAY impl */
+    case 0xA9: lda(operand<0xA9>()); break;             /* LDA # */
+    case 0xAA: tax(); break;                            /* TAX impl */
+    case 0xAB: lxa(operand<0xAB>()); break;             /* LXA # ~ Illegal OPCode */
+    case 0xAC: ldy(operand<0xAC>()); break;             /* LDY abs */
+    case 0xAD: lda(operand<0xAD>()); break;             /* LDA abs */
+    case 0xAE: ldx(operand<0xAE>()); break;             /* LDX abs */
+    case 0xAF: lax(operand<0xAF>()); break;             /* LAX abs ~ Illegal OPCode */
+    /* 0xB0 ~ 0xBF */
+    case 0xB0: branch(cf()); break;                     /* BCS rel */
+    case 0xB1: lda(operand<0xB1>()); break;             /* LDA ind,Y */
+    case 0xB2: jam(0xB2); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0xB3: lax(operand<0xB3>()); break;             /* LAX ind,Y ~ Illegal OPCode */
+    case 0xB4: ldy(operand<0xB4>()); break;             /* LDY zpg,X */
+    case 0xB5: lda(operand<0xB5>()); break;             /* LDA zpg,X */
+    case 0xB6: ldx(operand<0xB6>()); break;             /* LDX zpg,Y */
+    case 0xB7: lax(operand<0xB7>()); break;             /* LAX zpg,Y ~ Illegal OPCode */
+    case 0xB8: clv(); break;                            /* CLV impl */
+    case 0xB9: lda(operand<0xB9>()); break;             /* LDA abs,Y */
+    case 0xBA: tsx(); break;                            /* TSX impl */
+    case 0xBB: las(operand<0xBB>()); break;             /* LAS abs,Y ~ Illegal OPCode */
+    case 0xBC: ldy(operand<0xBC>()); break;             /* LDY abs,X */
+    case 0xBD: lda(operand<0xBD>()); break;             /* LDA abs,X */
+    case 0xBE: ldx(operand<0xBE>()); break;             /* LDX abs,Y */
+    case 0xBF: lax(operand<0xBF>()); break;             /* LAX abs,Y ~ Illegal OPCode */
+    /* 0xC0 ~ 0xCF */
+    case 0xC0: cpy(operand<0xC0>()); break;             /* CPY # */
+    case 0xC1: cmp(operand<0xC1>()); break;             /* CMP X,ind */
+    case 0xC2: operand<0xC2>(); break;                  /* NOP # ~ Illegal OPCode */
+    case 0xC3: dcp(ea<0xC3>()); break;                  /* DCP X,ind ~ Illegal OPCode */
+    case 0xC4: cpy(operand<0xC4>()); break;             /* CPY zpg */
+    case 0xC5: cmp(operand<0xC5>()); break;             /* CMP zpg */
+    case 0xC6: dec(ea<0xC6>()); break;                  /* DEC zpg */
+    case 0xC7: dcp(ea<0xC7>()); break;                  /* DCP zpg ~ Illegal OPCode */
+    case 0xC8: iny(); break;                            /* INY impl */
+    case 0xC9: cmp(operand<0xC9>()); break;             /* CMP # */
+    case 0xCA: dex(); break;                            /* DEX impl */
+    case 0xCB: sbx(operand<0xCB>()); break;             /* SBX # ~ Illegal OPCode */
+    case 0xCC: cpy(operand<0xCC>()); break;             /* CPY abs */
+    case 0xCD: cmp(operand<0xCD>()); break;             /* CMP abs */
+    case 0xCE: dec(ea<0xCE>()); break;                  /* DEC abs */
+    case 0xCF: dcp(ea<0xCF>()); break;                  /* DCP abs ~ Illegal OPCode */
+    /* 0xD0 ~ 0xDF */
+    case 0xD0: branch(!zf()); break;                    /* BNE rel */
+    case 0xD1: cmp(operand<0xD1>()); break;             /* CMP ind,Y */
+    case 0xD2: jam(0xD2); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0xD3: dcp(ea<0xD3>()); break;                  /* DCP ind,Y ~ Illegal OPCode */
+    case 0xD4: operand<0xD4>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0xD5: cmp(operand<0xD5>()); break;             /* CMP zpg,X */
+    case 0xD6: dec(ea<0xD6>()); break;                  /* DEC zpg,X */
+    case 0xD7: dcp(ea<0xD7>()); break;                  /* DCP zpg,X ~ Illegal OPCode */
+    case 0xD8: cld(); break;                            /* CLD impl */
+    case 0xD9: cmp(operand<0xD9>()); break;             /* CMP abs,Y */
+    case 0xDA: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0xDB: dcp(ea<0xDB>()); break;                  /* DCP abs,Y ~ Illegal OPCode */
+    case 0xDC: operand<0xDC>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0xDD: cmp(operand<0xDD>()); break;             /* CMP abs,X */
+    case 0xDE: dec(ea<0xDE>()); break;                  /* DEC abs,X */
+    case 0xDF: dcp(ea<0xDF>()); break;                  /* DCP abs,X ~ Illegal OPCode */
+    /* 0xE0 ~ 0xEF */
+    case 0xE0: cpx(operand<0xE0>()); break;             /* CPX # */
+    case 0xE1: sbc(operand<0xE1>()); break;             /* SBC X,ind */
+    case 0xE2: operand<0xE2>(); break;                  /* NOP # ~ Illegal OPCode */
+    case 0xE3: isc(ea<0xE3>()); break;                  /* ISC X,ind ~ Illegal OPCode */
+    case 0xE4: cpx(operand<0xE4>()); break;             /* CPX zpg */
+    case 0xE5: sbc(operand<0xE5>()); break;             /* SBC zpg */
+    case 0xE6: inc(ea<0xE6>()); break;                  /* INC zpg */
+    case 0xE7: isc(ea<0xE7>()); break;                  /* ISC zpg ~ Illegal OPCode */
+    case 0xE8: inx(); break;                            /* INX impl */
+    case 0xE9: sbc(operand<0xE9>()); break;             /* SBC # */
+    case 0xEA: break;                                   /* NOP impl */
+    case 0xEB: sbc(operand<0xEB>()); break;             /* USBC # ~ Illegal OPCode */
+    case 0xEC: cpx(operand<0xEC>()); break;             /* CPX abs */
+    case 0xED: sbc(operand<0xED>()); break;             /* SBC abs */
+    case 0xEE: inc(ea<0xEE>()); break;                  /* INC abs */
+    case 0xEF: isc(ea<0xEF>()); break;                  /* ISC abs ~ Illegal OPCode */
+    /* 0xF0 ~ 0xFF */
+    case 0xF0: branch(zf()); break;                     /* BEQ rel */
+    case 0xF1: sbc(operand<0xF1>()); break;             /* SBC ind,Y */
+    case 0xF2: jam(0xF2); break;                        /* JAM impl ~ Illegal OPCode */
+    case 0xF3: isc(ea<0xF3>()); break;                  /* ISC ind,Y ~ Illegal OPCode */
+    case 0xF4: operand<0xF4>(); break;                  /* NOP zpg,X ~ Illegal OPCode */
+    case 0xF5: sbc(operand<0xF5>()); break;             /* SBC zpg,X */
+    case 0xF6: inc(ea<0xF6>()); break;                  /* INC zpg,X */
+    case 0xF7: isc(ea<0xF7>()); break;                  /* ISC zpg,X ~ Illegal OPCode */
+    case 0xF8: sed(); break;                            /* SED impl */
+    case 0xF9: sbc(operand<0xF9>()); break;             /* SBC abs,Y */
+    case 0xFA: break;                                   /* NOP impl ~ Illegal OPCode */
+    case 0xFB: isc(ea<0xFB>()); break;                  /* ISC abs,Y ~ Illegal OPCode */
+    case 0xFC: operand<0xFC>(); break;                  /* NOP abs,X ~ Illegal OPCode */
+    case 0xFD: sbc(operand<0xFD>()); break;             /* SBC abs,X */
+    case 0xFE: inc(ea<0xFE>()); break;                  /* INC abs,X */
+    case 0xFF: isc(ea<0xFF>()); break;                  /* ISC abs,X ~ Illegal OPCode */
+  }
+  return;
+}
+
+/**
+ * @brief Execute an opcode by instruction number
+ *
+ * @param opcode
+ */
+void __us_not_in_flash_func(execute) mos6510::execute(val_t opcode)
+{
+  dispatch(opcode);
+  /* Base cycles plus the page boundary penalty if applicable */
+  const opcode_t &op = mos6510_opcodes[opcode];
+  tick(op.cycles + (op.pb_penalty & pb_crossed));
+  return;
+}
+
+/* Idle loops */
+
+/**
+ * @brief Remember a short backward jump as a possible idle loop
+ */
+_MOS_INLINE void __us_not_in_flash_func(idle_candidate) mos6510::idle_candidate(addr_t addr)
+{
+  if _MOS_UNLIKELY ((addr_t)(pc_ - addr) <= kIdleLoopMaxBytes) {
+    idle_loop_ = true;
+    idle_pc_ = addr;
+  }
+}
+
+/**
+ * @brief Fast forward over an idle loop at pc
+ * @return returns true if cycles were skipped
+ *
+ * Only loops made of implied NOPs closed by a JMP or a taken branch
+ * back to pc qualify, those change nothing but the clock. Whole loop
+ * iterations are skipped up to the next peripheral alarm or the run
+ * loop budget in idle_limit, whichever comes first, so the
+ * peripherals see the same cycle at every poll as when stepping
+ * through the loop and the run loop returns at its budget.
+ */
+bool __us_not_in_flash_func(idle_skip) mos6510::idle_skip(void)
+{
+  if (!idle_skip_enabled || check_callback()) return false;
+
+  addr_t addr = pc_;
+  cycle_t period = 0;
+  bool closed = false;
+  while (!closed) {
+    addr_t end = (addr + 2);
+    if ((addr_t)(addr - pc_) > kIdleLoopMaxBytes
+        || ((addr >> 8) >= 0xd0 && (addr >> 8) <= 0xdf)
+        || ((end >> 8) >= 0xd0 && (end >> 8) <= 0xdf)) {
+      idle_loop_ = false;
+      return false;
+    }
+    val_t opcode = fetch_byte(addr);
+    bool cond;
+    switch (opcode) {
+      case 0xEA: case 0x1A: case 0x3A: /* NOP */
+      case 0x5A: case 0x7A: case 0xDA: case 0xFA:
+        period += mos6510_opcodes[opcode].cycles;
+        addr++;
+        continue;
+      case 0x4C: /* JMP */
+        if ((fetch_byte(addr + 1) | (fetch_byte(addr + 2) << 8)) != pc_) break;
+        period += mos6510_opcodes[opcode].cycles;
+        closed = true;
+        continue;
+      case 0x10: cond = !nf(); goto branch; /* BPL */
+      case 0x30: cond = nf();  goto branch; /* BMI */
+      case 0x50: cond = !of(); goto branch; /* BVC */
+      case 0x70: cond = of();  goto branch; /* BVS */
+      case 0x90: cond = !cf(); goto branch; /* BCC */
+      case 0xB0: cond = cf();  goto branch; /* BCS */
+      case 0xD0: cond = !zf(); goto branch; /* BNE */
+      case 0xF0: cond = zf();  goto branch; /* BEQ */
+      branch:
+        if (!cond || (addr_t)((int8_t)fetch_byte(addr + 1) + addr + 2) != pc_) break;
+        period += (mos6510_opcodes[opcode].cycles + ((((addr + 2) ^ pc_) & 0xff00) ? 2 : 1));
+        closed = true;
+        continue;
+      default:
+        break;
+    }
+    /* Not an idle loop */
+    idle_loop_ = false;
+    return false;
+  }
+
+  CPUCLOCK next = MIN(alarms.next(), idle_limit);
+  if (next == RUN_FOREVER || next <= cycles_) return false;
+
+  CPUCLOCK skip = (((next - cycles_) / period) * period);
+  if (skip == 0) return false;
+  cycles_ += skip;
+  idle_skipped_cycles_ += skip;
+  idle_skips_++;
+  return true;
+}
+
+/* Superblocks */
+
+/**
+ * @brief Superblock entry for an opcode, the constant opcode
+ * folds dispatch down to the single handler
+ */
+template<val_t op>
+void mos6510::superblock_handler(mos6510 * cpu)
+{
+  cpu->dispatch(op);
+}
+
+/**
+ * @brief Returns true if the instruction cannot be part of a superblock
+ *
+ * Anything that branches, changes the interrupt flag or might
+ * touch the IO area ($D000-$DFFF) ends a superblock, indirect
+ * addressing is unknown at translation time so it always ends one.
+ */
+_MOS_INLINE bool __us_not_in_flash_func(superblock_ends) mos6510::superblock_ends(val_t opcode, addr_t operand)
+{
+  switch (opcode) {
+    case 0x00: /* BRK */
+    case 0x20: /* JSR */
+    case 0x28: /* PLP */
+    case 0x40: /* RTI */
+    case 0x4C: /* JMP */
+    case 0x58: /* CLI */
+    case 0x60: /* RTS */
+    case 0x78: /* SEI */
+    case 0x02: case 0x12: case 0x22: case 0x32: /* JAM */
+    case 0x42: case 0x52: case 0x62: case 0x72:
+    case 0x92: case 0xB2: case 0xD2: case 0xF2:
+      return true;
+    default:
+      break;
+  }
+  switch (mos6510_opcodes[opcode].mode) {
+    case kRelative:
+    case kIndirect:
+    case kIndirectX:
+    case kIndirectY:
+      return true;
+    case kAbsolute:
+      return (operand >= pAddrVicFirstPage && operand <= (pAddrIO2Page + pC64PageEnd));
+    case kAbsoluteX:
+    case kAbsoluteY:
+      return (operand <= (pAddrIO2Page + pC64PageEnd) && (operand + 0xff) >= pAddrVicFirstPage);
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Mark a byte as translated so writes to it invalidate its page
+ */
+_MOS_INLINE void __us_not_in_flash_func(superblock_mark) mos6510::superblock_mark(addr_t addr)
+{
+  superblock_code_[(addr >> 8)][((addr & 0xff) >> 6)] |= (1ULL << (addr & 0x3f));
+}
+
+#define SB_H(op) &mos6510::superblock_handler<(op)>
+#define SB_ROW(r) \
+  SB_H(r|0x0),SB_H(r|0x1),SB_H(r|0x2),SB_H(r|0x3),SB_H(r|0x4),SB_H(r|0x5),SB_H(r|0x6),SB_H(r|0x7), \
+  SB_H(r|0x8),SB_H(r|0x9),SB_H(r|0xA),SB_H(r|0xB),SB_H(r|0xC),SB_H(r|0xD),SB_H(r|0xE),SB_H(r|0xF)
+
+/**
+ * @brief Returns the superblock starting at addr, translating
+ * it if there is none or the code underneath changed
+ *
+ * A superblock with a count of 0 marks an instruction that
+ * has to be interpreted.
+ */
+mos6510::superblock_t * __us_not_in_flash_func(superblock) mos6510::superblock(addr_t addr)
+{
+  static const SuperblockHandler handlers[0x100] = {
+    SB_ROW(0x00),SB_ROW(0x10),SB_ROW(0x20),SB_ROW(0x30),SB_ROW(0x40),SB_ROW(0x50),SB_ROW(0x60),SB_ROW(0x70),
+    SB_ROW(0x80),SB_ROW(0x90),SB_ROW(0xA0),SB_ROW(0xB0),SB_ROW(0xC0),SB_ROW(0xD0),SB_ROW(0xE0),SB_ROW(0xF0),
+  };
+
+  val_t page = (addr >> 8);
+  superblock_t ** blocks = superblocks_[page];
+  if _MOS_UNLIKELY(blocks == nullptr) {
+    blocks = superblocks_[page] = new superblock_t*[0x100]();
+  }
+  superblock_t * b = blocks[(addr & 0xff)];
+  if _MOS_LIKELY(b != nullptr
+    && b->gen[0] == superblock_gen_[b->first_page]
+    && b->gen[1] == superblock_gen_[b->last_page]) {
+    return b;
+  }
+  if (b == nullptr) {
+    b = blocks[(addr & 0xff)] = new superblock_t();
+  }
+
+  /* Translate, reading through the bus is safe as the IO pages are never read */
+  addr_t a = addr, last = addr;
+  cycle_t cycles = 0;
+  b->count = 0;
+  while (b->count < kSuperblockMaxInsns) {
+    val_t opcode = fetch_byte(a);
+    const opcode_t &op = mos6510_opcodes[opcode];
+    addr_t end = (a + op.length - 1);
+    if (((a >> 8) >= 0xd0 && (a >> 8) <= 0xdf) || ((end >> 8) >= 0xd0 && (end >> 8) <= 0xdf)) {
+      break;
+    }
+    val_t lo = ((op.length > 1) ? fetch_byte(a + 1) : 0);
+    val_t hi = ((op.length > 2) ? fetch_byte(a + 2) : 0);
+    /* The instruction ending the run is part of the translation as well */
+    for (int i = 0; i < op.length; i++) superblock_mark(a + i);
+    last = end;
+    if (superblock_ends(opcode, (lo | (hi << 8)))) {
+      break;
+    }
+    cycles += op.cycles;
+    superblock_insn_t &e = b->insn[b->count++];
+    e.fn = handlers[opcode];
+    e.pc = a;
+    e.bytes[0] = opcode, e.bytes[1] = lo, e.bytes[2] = hi;
+    e.pb_penalty = op.pb_penalty;
+    e.cycles = cycles;
+    a += op.length;
+  }
+  b->first_page = page;
+  b->last_page = (last >> 8);
+  b->gen[0] = superblock_gen_[b->first_page];
+  b->gen[1] = superblock_gen_[b->last_page];
+  superblock_stats_.translations++;
+  return b;
+}
+
+#undef SB_ROW
+#undef SB_H
+
+/**
+ * @brief emulate a superblock
+ * @return returns false if something goes wrong
+ *
+ * Runs the translated instructions at pc and clocks their summed
+ * cycles once at the end, the cycle count at exit matches
+ * emulate() for the same instructions. Instructions that can't be
+ * translated are handed to step<trace_off>(). Interrupts raised
+ * during a superblock are taken at its exit. Superblocks are never
+ * traced, the traced loop steps single instructions.
+ */
+bool __us_not_in_flash_func(emulate_block) mos6510::emulate_block(void)
+{
+  if _MOS_UNLIKELY (idle_loop_ && pc_ == idle_pc_ && idle_skip()) { return true; }
+
+  superblock_t * b = superblock(pc_);
+  if (b->count == 0) { return step<trace_off>(); }
+
+  uint_least32_t invalidations = superblock_invalidations_;
+  cycle_t penalty = 0;
+  int i = 0;
+  for (;;) {
+    const superblock_insn_t &e = b->insn[i++];
+    pc_ = (e.pc + 1);
+    ibuf_ = &e.bytes[1];
+    pb_crossed = false;
+    e.fn(this);
+    penalty += (e.pb_penalty & pb_crossed);
+    if (i == b->count) break;
+    /* The instruction wrote to translated code or switched banks */
+    if _MOS_UNLIKELY(invalidations != superblock_invalidations_) {
+      superblock_stats_.aborts++;
+      break;
+    }
+  }
+  ibuf_ = nullptr;
+  pb_crossed = false;
+  last_insn = b->insn[i - 1].bytes[0];
+  tick(b->insn[i - 1].cycles + penalty);
+
+  superblock_stats_.runs++;
+  superblock_stats_.insns += i;
+  return true;
+}
+
+void mos6510::dump_superblock_stats(void)
+{
+  MOSDBG("[CPU] Superblock translations: %llu runs: %llu insns: %llu (%.2f per run) aborts: %llu invalidations: %llu\n",
+    (unsigned long long)superblock_stats_.translations,
+    (unsigned long long)superblock_stats_.runs,
+    (unsigned long long)superblock_stats_.insns,
+    (superblock_stats_.runs ? ((double)superblock_stats_.insns / superblock_stats_.runs) : 0.0),
+    (unsigned long long)superblock_stats_.aborts,
+    (unsigned long long)superblock_stats_.invalidations);
+}
+
 /* Data handling and memory operations */
 
 /**
  * @brief STore Accumulator
  */
-void __us_not_in_flash_func(sta) mos6510::sta(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(sta) mos6510::sta(addr_t addr)
 {
   save_byte(addr,a());
-  tick(cycles);
 }
 
 /**
  * @brief STore X
  */
-void __us_not_in_flash_func(stx) mos6510::stx(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(stx) mos6510::stx(addr_t addr)
 {
   save_byte(addr,x());
-  tick(cycles);
 }
 
 /**
  * @brief STore Y
  */
-void __us_not_in_flash_func(sty) mos6510::sty(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(sty) mos6510::sty(addr_t addr)
 {
   save_byte(addr,y());
-  tick(cycles);
 }
 
 /**
@@ -685,7 +1164,6 @@ void __us_not_in_flash_func(sty) mos6510::sty(addr_t addr, cycle_t cycles)
 void __us_not_in_flash_func(txs) mos6510::txs()
 {
   sp(x());
-  tick(2);
 }
 
 /**
@@ -694,47 +1172,34 @@ void __us_not_in_flash_func(txs) mos6510::txs()
 void __us_not_in_flash_func(tsx) mos6510::tsx()
 {
   x(sp());
-  SET_ZF(x());
-  SET_NF(x());
-  tick(2);
+  SET_NZ(x());
 }
 
 /**
  * @brief LoaD Accumulator
  */
-void __us_not_in_flash_func(lda) mos6510::lda(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(lda) mos6510::lda(val_t v)
 {
   a(v);
-  // SET_ZF(a());
-  zf(!a());
-  // SET_NF(a());
-  nf((a()&0x80)!=0);
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(a());
 }
 
 /**
  * @brief LoaD X
  */
-void __us_not_in_flash_func(ldx) mos6510::ldx(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(ldx) mos6510::ldx(val_t v)
 {
   x(v);
-  SET_ZF(x());
-  SET_NF(x());
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(x());
 }
 
 /**
  * @brief LoaD Y
  */
-void __us_not_in_flash_func(ldy) mos6510::ldy(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(ldy) mos6510::ldy(val_t v)
 {
   y(v);
-  SET_ZF(y());
-  SET_NF(y());
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(y());
 }
 
 /**
@@ -743,9 +1208,7 @@ void __us_not_in_flash_func(ldy) mos6510::ldy(val_t v, cycle_t cycles)
 void __us_not_in_flash_func(txa) mos6510::txa()
 {
   a(x());
-  SET_ZF(a());
-  SET_NF(a());
-  tick(2);
+  SET_NZ(a());
 }
 
 /**
@@ -754,9 +1217,7 @@ void __us_not_in_flash_func(txa) mos6510::txa()
 void __us_not_in_flash_func(tax) mos6510::tax()
 {
   x(a());
-  SET_ZF(x());
-  SET_NF(x());
-  tick(2);
+  SET_NZ(x());
 }
 
 /**
@@ -765,9 +1226,7 @@ void __us_not_in_flash_func(tax) mos6510::tax()
 void __us_not_in_flash_func(tay) mos6510::tay()
 {
   y(a());
-  SET_ZF(y());
-  SET_NF(y());
-  tick(2);
+  SET_NZ(y());
 }
 
 /**
@@ -776,9 +1235,7 @@ void __us_not_in_flash_func(tay) mos6510::tay()
 void __us_not_in_flash_func(tya) mos6510::tya()
 {
   a(y());
-  SET_ZF(a());
-  SET_NF(a());
-  tick(2);
+  SET_NZ(a());
 }
 
 /**
@@ -787,7 +1244,6 @@ void __us_not_in_flash_func(tya) mos6510::tya()
 void __us_not_in_flash_func(pha) mos6510::pha()
 {
   push(a());
-  tick(3);
 }
 
 /**
@@ -796,9 +1252,7 @@ void __us_not_in_flash_func(pha) mos6510::pha()
 void __us_not_in_flash_func(pla) mos6510::pla()
 {
   a(pop());
-  SET_ZF(a());
-  SET_NF(a());
-  tick(4);
+  SET_NZ(a());
 }
 
 /* Logic operations */
@@ -806,37 +1260,30 @@ void __us_not_in_flash_func(pla) mos6510::pla()
 /**
  * @brief Logical OR on Accumulator
  */
-void __us_not_in_flash_func(ora) mos6510::ora(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(ora) mos6510::ora(val_t v)
 {
   a(a()|v);
-  SET_ZF(a());
-  SET_NF(a());
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(a());
 }
 
 /**
  * @brief Logical AND
  */
-void __us_not_in_flash_func(_and) mos6510::_and(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(_and) mos6510::_and(val_t v)
 {
   a(a()&v);
-  SET_ZF(a());
-  SET_NF(a());
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(a());
 }
 
 /**
  * @brief BIT test
  */
-void __us_not_in_flash_func(bit) mos6510::bit(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(bit) mos6510::bit(addr_t addr)
 {
   val_t t = load_byte(addr);
   SET_NF(t);
   SET_OF(t);
   SET_ZF(t&a());
-  tick(cycles);
 }
 
 /**
@@ -847,8 +1294,7 @@ val_t __us_not_in_flash_func(rol) mos6510::rol(val_t v)
   addr_t t = (v << 1) | (val_t)cf();
   cf((t&0x100)!=0);
   // SET_CF(t); // BUG: Not working yet :-)
-  SET_ZF(t);
-  SET_NF(t);
+  SET_NZ(t);
   return (val_t)t;
 }
 
@@ -858,19 +1304,17 @@ val_t __us_not_in_flash_func(rol) mos6510::rol(val_t v)
 void __us_not_in_flash_func(rol_a) mos6510::rol_a()
 {
   a(rol(a()));
-  tick(2);
 }
 
 /**
  * @brief ROL mem
  */
-void __us_not_in_flash_func(rol_mem) mos6510::rol_mem(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(rol_mem) mos6510::rol_mem(addr_t addr)
 {
   val_t v = load_byte(addr);
   /* see ASL doc */
   save_byte(addr,v);
   save_byte(addr,rol(v));
-  tick(cycles);
 }
 
 /**
@@ -880,8 +1324,7 @@ val_t __us_not_in_flash_func(ror) mos6510::ror(val_t v)
 {
   addr_t t = (v >> 1) | (val_t)(cf() << 7);
   cf((v&0x1)!=0);
-  SET_ZF(t);
-  SET_NF(t);
+  SET_NZ(t);
   return (val_t)t;
 }
 
@@ -891,19 +1334,17 @@ val_t __us_not_in_flash_func(ror) mos6510::ror(val_t v)
 void __us_not_in_flash_func(ror_a) mos6510::ror_a()
 {
   a(ror(a()));
-  tick(2);
 }
 
 /**
  * @brief ROR mem
  */
-void __us_not_in_flash_func(ror_mem) mos6510::ror_mem(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(ror_mem) mos6510::ror_mem(addr_t addr)
 {
   val_t v = load_byte(addr);
   /* see ASL doc */
   save_byte(addr,v);
   save_byte(addr,ror(v));
-  tick(cycles);
 }
 
 /**
@@ -913,8 +1354,7 @@ val_t __us_not_in_flash_func(lsr) mos6510::lsr(val_t v)
 {
   val_t t = v >> 1;
   cf((v&0x1)!=0);
-  SET_ZF(t);
-  SET_NF(t);
+  SET_NZ(t);
   return t;
 }
 
@@ -924,19 +1364,17 @@ val_t __us_not_in_flash_func(lsr) mos6510::lsr(val_t v)
 void __us_not_in_flash_func(lsr_a) mos6510::lsr_a()
 {
   a(lsr(a()));
-  tick(2);
 }
 
 /**
  * @brief LSR mem
  */
-void __us_not_in_flash_func(lsr_mem) mos6510::lsr_mem(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(lsr_mem) mos6510::lsr_mem(addr_t addr)
 {
   val_t v = load_byte(addr);
   /* see ASL doc */
   save_byte(addr,v);
   save_byte(addr,lsr(v));
-  tick(cycles);
 }
 
 /**
@@ -946,8 +1384,7 @@ val_t __us_not_in_flash_func(asl) mos6510::asl(val_t v)
 {
   val_t t = (v << 1) & 0xff;
   cf((v&0x80)!=0);
-  SET_ZF(t);
-  SET_NF(t);
+  SET_NZ(t);
   return t;
 }
 
@@ -957,7 +1394,6 @@ val_t __us_not_in_flash_func(asl) mos6510::asl(val_t v)
 void __us_not_in_flash_func(asl_a) mos6510::asl_a()
 {
   a(asl(a()));
-  tick(2);
 }
 
 /**
@@ -982,24 +1418,20 @@ void __us_not_in_flash_func(asl_a) mos6510::asl_a()
  *
  * So.. we need to mimic the behaviour.
  */
-void __us_not_in_flash_func(asl_mem) mos6510::asl_mem(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(asl_mem) mos6510::asl_mem(addr_t addr)
 {
   val_t v = load_byte(addr);
   save_byte(addr,v);
   save_byte(addr,asl(v));
-  tick(cycles);
 }
 
 /**
  * @brief Exclusive OR
  */
-void __us_not_in_flash_func(eor) mos6510::eor(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(eor) mos6510::eor(val_t v)
 {
   a(a()^v);
-  SET_ZF(a());
-  SET_NF(a());
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(a());
 }
 
 /* Arithmetic operations */
@@ -1007,31 +1439,27 @@ void __us_not_in_flash_func(eor) mos6510::eor(val_t v, cycle_t cycles)
 /**
  * @brief INCrement
  */
-void __us_not_in_flash_func(inc) mos6510::inc(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(inc) mos6510::inc(addr_t addr)
 {
   val_t v = load_byte(addr);
   /* see ASL doc */
   save_byte(addr,v);
   v++;
   save_byte(addr,v);
-  SET_ZF(v);
-  SET_NF(v);
-  tick(cycles);
+  SET_NZ(v);
 }
 
 /**
  * @brief DECrement
  */
-void __us_not_in_flash_func(dec) mos6510::dec(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(dec) mos6510::dec(addr_t addr)
 {
   val_t v = load_byte(addr);
   /* see ASL doc */
   save_byte(addr,v);
   v--;
   save_byte(addr,v);
-  SET_ZF(v);
-  SET_NF(v);
-  tick(cycles);  // was missing
+  SET_NZ(v);
 }
 
 /**
@@ -1040,9 +1468,7 @@ void __us_not_in_flash_func(dec) mos6510::dec(addr_t addr, cycle_t cycles)
 void __us_not_in_flash_func(inx) mos6510::inx()
 {
   x_+=1;
-  SET_ZF(x());
-  SET_NF(x());
-  tick(2);
+  SET_NZ(x());
 }
 
 /**
@@ -1052,9 +1478,7 @@ void __us_not_in_flash_func(iny) mos6510::iny()
 {
   // y_+=1;
   y(y()+1);
-  SET_ZF(y());
-  SET_NF(y());
-  tick(2);
+  SET_NZ(y());
 }
 
 /**
@@ -1063,9 +1487,7 @@ void __us_not_in_flash_func(iny) mos6510::iny()
 void __us_not_in_flash_func(dex) mos6510::dex()
 {
   x_-=1;
-  SET_ZF(x());
-  SET_NF(x());
-  tick(2);
+  SET_NZ(x());
 }
 
 /**
@@ -1075,68 +1497,79 @@ void __us_not_in_flash_func(dey) mos6510::dey()
 {
   y_-=1;
   // y(y()-1);
-  SET_ZF(y());
-  SET_NF(y());
-  tick(2);
+  SET_NZ(y());
+}
+
+/**
+ * @brief Decimal mode ADC kernel, NMOS behaviour
+ *
+ * Branch free, the nibble adjustments are selected with
+ * masks instead of conditional adds
+ *
+ * @return 9 bit result, bit 8 is the carry out
+ */
+static _MOS_INLINE addr_t adc_bcd(addr_t a, addr_t v, addr_t c)
+{
+  addr_t t = ((a & 0xf) + (v & 0xf) + c);
+  t += (0x06 & -(addr_t)(t > 0x09));
+  t += ((a & 0xf0) + (v & 0xf0));
+  t += (0x60 & -(addr_t)((t & 0x1f0) > 0x90));
+  return t;
+}
+
+/**
+ * @brief Decimal mode SBC kernel, NMOS behaviour
+ *
+ * Branch free counterpart of adc_bcd, bit 8 of the
+ * result is set on borrow
+ *
+ * @return 16 bit result, below 0x100 when there's no borrow
+ */
+static _MOS_INLINE addr_t sbc_bcd(addr_t a, addr_t v, addr_t c)
+{
+  addr_t t = ((a & 0xf) - (v & 0xf) - (c ^ 1));
+  const addr_t half = ((t >> 4) & 1);
+  t = (((t - (0x06 & -half)) & 0xf) | ((a & 0xf0) - (v & 0xf0) - (0x10 & -half)));
+  t -= (0x60 & -((t >> 8) & 1));
+  return t;
 }
 
 /**
  * @brief ADd with Carry
  */
-void __us_not_in_flash_func(adc) mos6510::adc(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(adc) mos6510::adc(val_t v)
 {
+  const addr_t c = (_flags & SR_CARRY);
   addr_t t;
-  if(dmf())
-  {
-    t = (a()&0xf) + (v&0xf) + (cf() ? 1 : 0);
-    if (t > 0x09)
-      t += 0x6;
-    t += (a()&0xf0) + (v&0xf0);
-    if((t & 0x1f0) > 0x90)
-      t += 0x60;
-  }
-  else
-  {
-    t = a() + v + (cf() ? 1 : 0);
+  if _MOS_UNLIKELY (dmf()) {
+    t = adc_bcd(a_, v, c);
+  } else {
+    t = (a_ + v + c);
   }
   cf(t>0xff);
   t=t&0xff;
-  of(!((a()^v)&0x80) && ((a()^t) & 0x80));
-  SET_ZF(t);
-  SET_NF(t);
-  a((val_t)t);
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  of(~(a_^v) & (a_^t) & 0x80);
+  SET_NZ(t);
+  a_ = (val_t)t;
 }
 
 /**
  * @brief SuBstract with Carry
  */
-void __us_not_in_flash_func(sbc) mos6510::sbc(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(sbc) mos6510::sbc(val_t v)
 {
+  const addr_t c = (_flags & SR_CARRY);
   addr_t t;
-  if(dmf())
-  {
-    t = (a()&0xf) - (v&0xf) - (cf() ? 0 : 1);
-    if((t & 0x10) != 0)
-      t = ((t-0x6)&0xf) | ((a()&0xf0) - (v&0xf0) - 0x10);
-    else
-      t = (t&0xf) | ((a()&0xf0) - (v&0xf0));
-    if((t&0x100)!=0)
-      t -= 0x60;
-  }
-  else
-  {
-    t = a() - v - (cf() ? 0 : 1);
+  if _MOS_UNLIKELY (dmf()) {
+    t = sbc_bcd(a_, v, c);
+  } else {
+    t = (a_ - v - (c ^ 1));
   }
   cf(t<0x100);
   t=t&0xff;
-  of(((a()^t)&0x80) && ((a()^v) & 0x80));
-  SET_ZF(t);
-  SET_NF(t);
-  a((val_t)t);
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  of((a_^t) & (a_^v) & 0x80);
+  SET_NZ(t);
+  a_ = (val_t)t;
 }
 
 /* Flag access */
@@ -1147,7 +1580,6 @@ void __us_not_in_flash_func(sbc) mos6510::sbc(val_t v, cycle_t cycles)
 void __us_not_in_flash_func(sei) mos6510::sei()
 {
   idf(true);
-  tick(2);
 }
 
 /**
@@ -1156,7 +1588,6 @@ void __us_not_in_flash_func(sei) mos6510::sei()
 void __us_not_in_flash_func(cli) mos6510::cli()
 {
   idf(false);
-  tick(2);
 }
 
 /**
@@ -1165,7 +1596,6 @@ void __us_not_in_flash_func(cli) mos6510::cli()
 void __us_not_in_flash_func(sec) mos6510::sec()
 {
   cf(true);
-  tick(2);
 }
 
 /**
@@ -1174,7 +1604,6 @@ void __us_not_in_flash_func(sec) mos6510::sec()
 void __us_not_in_flash_func(clc) mos6510::clc()
 {
   cf(false);
-  tick(2);
 }
 
 /**
@@ -1183,7 +1612,6 @@ void __us_not_in_flash_func(clc) mos6510::clc()
 void __us_not_in_flash_func(sed) mos6510::sed()
 {
   dmf(true);
-  tick(2);
 }
 
 /**
@@ -1192,7 +1620,6 @@ void __us_not_in_flash_func(sed) mos6510::sed()
 void __us_not_in_flash_func(cld) mos6510::cld()
 {
   dmf(false);
-  tick(2);
 }
 
 /**
@@ -1201,7 +1628,6 @@ void __us_not_in_flash_func(cld) mos6510::cld()
 void __us_not_in_flash_func(clv) mos6510::clv()
 {
   of(false);
-  tick(2);
 }
 
 val_t __us_not_in_flash_func(flags) mos6510::flags()
@@ -1229,7 +1655,6 @@ void __us_not_in_flash_func(php) mos6510::php()
 {
   push(flags()|0x10);  /* brk & php instructions push the bcf flag active */
   // push(flags());  /* brk & php instructions push the bcf flag active */
-  tick(3);
 }
 
 /**
@@ -1238,7 +1663,6 @@ void __us_not_in_flash_func(php) mos6510::php()
 void __us_not_in_flash_func(plp) mos6510::plp()
 {
   flags(pop());
-  tick(4);
 }
 
 /**
@@ -1254,7 +1678,6 @@ void __us_not_in_flash_func(jsr) mos6510::jsr()
   push(((pc()-1) >> 8) & 0xff);
   push(((pc()-1) & 0xff));
   pc(addr);
-  tick(6);
 }
 
 /**
@@ -1263,8 +1686,8 @@ void __us_not_in_flash_func(jsr) mos6510::jsr()
 void __us_not_in_flash_func(jmp) mos6510::jmp()
 {
   addr_t addr = addr_abs();
+  idle_candidate(addr);
   pc(addr);
-  tick(3);
 }
 
 /**
@@ -1278,8 +1701,6 @@ void __us_not_in_flash_func(jmp_ind) mos6510::jmp_ind()
   /* Introduce indirect JMP bug */
   addr = (((t&0xFF)==0xFF)?((t&0xFF00)|(addr&0xFF)):addr);
   pc(addr);
-  // tick(3); // incorrect
-  tick(5);
 }
 
 /**
@@ -1294,184 +1715,58 @@ void __us_not_in_flash_func(rts) mos6510::rts()
 	hi = pop();
 
 	pc(((hi << 8) | lo) + 1);
-  tick(6);
 }
 
 /**
  * @brief CoMPare
  */
-void __us_not_in_flash_func(cmp) mos6510::cmp(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(cmp) mos6510::cmp(val_t v)
 {
   addr_t t;
   t = a() - v;
   cf(t<0x100);
   t = t&0xff;
-  SET_ZF(t);
-  SET_NF(t);
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(t);
 }
 
 /**
  * @brief CoMPare X
  */
-void __us_not_in_flash_func(cpx) mos6510::cpx(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(cpx) mos6510::cpx(val_t v)
 {
   addr_t t;
   t = x() - v;
   cf(t<0x100);
   t = t&0xff;
-  SET_ZF(t);
-  SET_NF(t);
-  tick(cycles);
+  SET_NZ(t);
 }
 
 /**
  * @brief CoMPare Y
  */
-void __us_not_in_flash_func(cpy) mos6510::cpy(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(cpy) mos6510::cpy(val_t v)
 {
   addr_t t;
   t = y() - v;
   cf(t<0x100);
   t = t&0xff;
-  SET_ZF(t);
-  SET_NF(t);
-  tick(cycles);
+  SET_NZ(t);
 }
 
 /**
- * @brief Branch if Not Equal
+ * @brief Branch on condition
+ *
+ * A taken branch adds one cycle to the base cycles or two
+ * if the target is in another page than the next instruction
  */
-void __us_not_in_flash_func(bne) mos6510::bne()
+void __us_not_in_flash_func(branch) mos6510::branch(bool cond)
 {
   addr_t addr = (int8_t) fetch_op() + pc();
-  // if(!zf()) {
-  if(!GETFLAG(SR_ZERO)) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief Branch if Equal
- */
-void __us_not_in_flash_func(beq) mos6510::beq()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(zf()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief Branch if Carry is Set
- */
-void __us_not_in_flash_func(bcs) mos6510::bcs()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(cf()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief Branch if Carry is Clear
- */
-void __us_not_in_flash_func(bcc) mos6510::bcc()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(!cf()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief,Branch if PLus
- */
-void __us_not_in_flash_func(bpl) mos6510::bpl()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(!nf()) {
+  if (cond) {
+    tick(((addr ^ pc()) & 0xff00) ? 2 : 1);
+    idle_candidate(addr);
     pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
   }
-  tick(2);
-}
-
-/**
- * @brief Branch if MInus
- */
-void __us_not_in_flash_func(bmi) mos6510::bmi()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(nf()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief Branch if oVerflow Clear
- */
-void __us_not_in_flash_func(bvc) mos6510::bvc()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(!of()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
-}
-
-/**
- * @brief Branch if oVerflow Set
- */
-void __us_not_in_flash_func(bvs) mos6510::bvs()
-{
-  addr_t addr = (int8_t) fetch_op();
-  curr_page = addr&0xff00;
-  addr += pc();
-  if ((addr&0xff00)>curr_page) pb_crossed = true;
-  if(of()) {
-    pc(addr);
-    if(pb_crossed) tick(2);
-    else tick(1);
-  }
-  tick(2);
 }
 
 /* Illegal instructions */
@@ -1495,35 +1790,30 @@ void __us_not_in_flash_func(jam) mos6510::jam(val_t insn)
   // reset();
   // exit(1);
   // pc(pc_--);
-  tick(1);
 }
 
 /**
  * @brief SLO (ASO) ASL oper + ORA oper
  *
  * @param addr
- * @param cycles_a
- * @param cycles_b
  */
-void __us_not_in_flash_func(slo) mos6510::slo(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
+void __us_not_in_flash_func(slo) mos6510::slo(addr_t addr)
 {
-  asl_mem(addr,cycles_a);
-  ora(load_byte(addr),cycles_b);
+  asl_mem(addr);
+  ora(load_byte(addr));
 }
 
-void __us_not_in_flash_func(lxa) mos6510::lxa(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(lxa) mos6510::lxa(val_t v)
 {
   val_t t = ((a() | 0xEE) & v);
   x(t);
   a(t);
-  SET_ZF(t);
-  SET_NF(t);
-  tick(cycles);
+  SET_NZ(t);
 }
 
 void __us_not_in_flash_func(anc) mos6510::anc(val_t v)
 {
-  _and(v,2);
+  _and(v);
   if(nf()) {
     cf(true);
   } else {
@@ -1537,110 +1827,74 @@ void __us_not_in_flash_func(las) mos6510::las(val_t v)
   a(t);
   x(t);
   sp(t);
-  SET_NF(t);
-  SET_ZF(t);
-  tick(4);
-  if(pb_crossed) tick(1);
+  SET_NZ(t);
 }
 
-void __us_not_in_flash_func(lax) mos6510::lax(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(lax) mos6510::lax(val_t v)
 {
-  lda(v,cycles);
+  lda(v);
   tax();
 }
 
-void __us_not_in_flash_func(sax) mos6510::sax(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(sax) mos6510::sax(addr_t addr)
 {
   val_t _a = a();
   val_t _x = x();
   val_t _r = (_a & _x);
   save_byte(addr,_r);
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(shy) mos6510::shy(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(shy) mos6510::shy(addr_t addr)
 {
   val_t t = ((addr >> 8) + 1);
   val_t y_ = y();
   save_byte(addr,(y_ & t));
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(shx) mos6510::shx(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(shx) mos6510::shx(addr_t addr)
 {
   val_t t = ((addr >> 8) + 1);
   val_t x_ = x();
   save_byte(addr,(x_ & t));
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(sha) mos6510::sha(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(sha) mos6510::sha(addr_t addr)
 {
   val_t t = ((addr >> 8) + 1);
   val_t a_ = a();
   val_t x_ = x();
   save_byte(addr,((a_ & x_) & t));
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(sre) mos6510::sre(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
+void __us_not_in_flash_func(sre) mos6510::sre(addr_t addr)
 {
   addr_t t = addr;
-  lsr_mem(t,cycles_a);
-  eor(load_byte(t),cycles_b);
+  lsr_mem(t);
+  eor(load_byte(t));
 }
 
-void __us_not_in_flash_func(rla) mos6510::rla(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
+void __us_not_in_flash_func(rla) mos6510::rla(addr_t addr)
 {
   addr_t t = addr;
-  rol_mem(t,cycles_a);
-  _and(load_byte(t),cycles_b);
+  rol_mem(t);
+  _and(load_byte(t));
 }
 
-void __us_not_in_flash_func(rla_) mos6510::rla_(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
-{
-  // addr_t t = addr;
-  // rol_mem(t,cycles_a);
-  // _and(load_byte(t),cycles_b);
-
-  // ROL_MEM
-  val_t v = load_byte(addr);
-  /* see ASL doc */
-  save_byte(addr,v);
-  // ROL
-  // save_byte(addr,rol(v));
-  addr_t t = (v << 1) | (val_t)cf();
-  cf((t&0x100)!=0);
-  SET_ZF(t);
-  SET_NF(t);
-  // return (val_t)t;
-  save_byte(addr,(val_t)t);
-  tick(cycles_a);
-
-  // AND
-  v = load_byte(addr);
-  a(a()&v);
-  SET_ZF(a());
-  SET_NF(a());
-  if(pb_crossed)cycles_b+=1;
-  tick(cycles_b);
-}
-
-void __us_not_in_flash_func(rra) mos6510::rra(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
+void __us_not_in_flash_func(rra) mos6510::rra(addr_t addr)
 {
   addr_t t = addr;
-  ror_mem(t,cycles_a);
-  adc(load_byte(t),cycles_b);
+  ror_mem(t);
+  adc(load_byte(t));
 }
 
-void __us_not_in_flash_func(dcp) mos6510::dcp(addr_t addr, cycle_t cycles_a,cycle_t cycles_b)
+void __us_not_in_flash_func(dcp) mos6510::dcp(addr_t addr)
 {
   addr_t t = addr;
-  dec(t,cycles_a);
-  cmp(load_byte(t),cycles_b);
+  dec(t);
+  cmp(load_byte(t));
 }
 
-void __us_not_in_flash_func(tas) mos6510::tas(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(tas) mos6510::tas(addr_t addr)
 {
   /* and accu, x and (highbyte + 1) of address */
   val_t v = (((a() & x()) & ((addr >> 8) + 1)));
@@ -1655,10 +1909,9 @@ void __us_not_in_flash_func(tas) mos6510::tas(addr_t addr, cycle_t cycles)
     save_byte(addr, v);
   }
   sp(a()&x()); /* write a & x to stackpointer unchanged */
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(sbx) mos6510::sbx(val_t v, cycle_t cycles)
+void __us_not_in_flash_func(sbx) mos6510::sbx(val_t v)
 {
   val_t a_ = a();
   val_t x_ = x();
@@ -1666,22 +1919,20 @@ void __us_not_in_flash_func(sbx) mos6510::sbx(val_t v, cycle_t cycles)
   addr_t t = r_ - v;
   cf(t<0x100);
   t = t&0xff;
-  SET_ZF(t);
-  SET_NF(t);
+  SET_NZ(t);
   x(t);
-  tick(cycles);
 }
 
-void __us_not_in_flash_func(isc) mos6510::isc(addr_t addr, cycle_t cycles)
+void __us_not_in_flash_func(isc) mos6510::isc(addr_t addr)
 {
-  inc(addr,cycles-=2);
+  inc(addr);
   val_t v = load_byte(addr);
-  sbc(v,cycles);
+  sbc(v);
 }
 
-void __us_not_in_flash_func(arr) mos6510::arr()
+void __us_not_in_flash_func(arr) mos6510::arr(val_t v)
 { /* Fixed code with courtesy of Vice 6510core.c */
-  unsigned int tmp = (a() & (fetch_op()));
+  unsigned int tmp = (a() & v);
   if(dmf()) {
     int tmp2 = tmp;
     tmp2 |= ((flags() & SR_CARRY) << 8);
@@ -1708,33 +1959,18 @@ void __us_not_in_flash_func(arr) mos6510::arr()
   } else {
     tmp |= ((flags() & SR_CARRY) << 8);
     tmp >>= 1;
-    SET_ZF(tmp);
-    SET_NF(tmp);
+    SET_NZ(tmp);
     cf((tmp & 0x40));
     of((tmp & 0x40) ^ ((tmp & 0x20) << 1));
     a(tmp);
   }
-  tick(2);
 }
 
 void __us_not_in_flash_func(xaa) mos6510::xaa(val_t v)
 {
   val_t t = ((a() | ANE_MAGIC) & x() & ((val_t)(v)));
   a(t);
-  SET_ZF(t);
-  SET_NF(t);
-  tick(2);
-}
-
-/* Miscellaneous */
-
-/**
- * @brief No OPeration
- */
-void __us_not_in_flash_func(nop) mos6510::nop(cycle_t cycles)
-{
-  if(pb_crossed)cycles+=1;
-  tick(cycles);
+  SET_NZ(t);
 }
 
 /* Clock logic */
@@ -1772,7 +2008,7 @@ void mos6510::tick_backup(cycle_t v)
   } while (v != 0);
 }
 
-void __us_not_in_flash_func(tick) mos6510::tick(cycle_t v)
+_MOS_INLINE void __us_not_in_flash_func(tick) mos6510::tick(cycle_t v)
 {
   bool v_iszero = (v == 0 ? true : false);
   if (v_iszero) return;
@@ -1802,8 +2038,6 @@ void __us_not_in_flash_func(rti) mos6510::rti()
 {
   flags(pop());
   pc(pop() + (pop() << 8));
-  // tick(7); /* 7?? */
-  tick(6);
 }
 
 /**
@@ -1811,9 +2045,9 @@ void __us_not_in_flash_func(rti) mos6510::rti()
  */
 void mos6510::handle_interrupts(void) /* BUG: Makes play way too fast */
 {
-  // if (loginstructions) {dump_regs_irq(0, (mos6510::nmi_pending ? 1 : 3));}
-  if (mos6510::nmi_pending || (mos6510::irq_pending && !idf())) {
-    /* MOSDBG("[handle_interrupts] NMI:%d IRQ:%d IDF:%d\n",mos6510::nmi_pending, mos6510::irq_pending, idf()); */
+  // if (loginstructions) {dump_regs_irq(0, (nmi_pending ? 1 : 3));}
+  if (nmi_pending || (irq_pending && !idf())) {
+    /* MOSDBG("[handle_interrupts] NMI:%d IRQ:%d IDF:%d\n",nmi_pending, irq_pending, idf()); */
     tick(2);
     push(((pc()) >> 8) & 0xff);
     push(((pc()) & 0xff));
@@ -1821,32 +2055,32 @@ void mos6510::handle_interrupts(void) /* BUG: Makes play way too fast */
     push((flags() & 0xef));  /* push flags with bcf cleared */
     tick(1);
     // TODO: Add check for pending alarms here
-    if (mos6510::nmi_pending) { /* NMI takes precedence over an IRQ */
-      mos6510::nmi_pending = false;
-      // if (!mos6510::irq_pending) { mos6510::pending_interrupt = false; };
-      // mos6510::pending_interrupt = false;
+    if (nmi_pending) { /* NMI takes precedence over an IRQ */
+      nmi_pending = false;
+      // if (!irq_pending) { pending_interrupt = false; };
+      // pending_interrupt = false;
       // idf(true);
       pc(load_word(pAddrNMIVector));
-    } else if (mos6510::irq_pending && !idf()){
-      mos6510::irq_pending = false;
-      // if (!mos6510::nmi_pending) { mos6510::pending_interrupt = false; };
-      // mos6510::pending_interrupt = false;
+    } else if (irq_pending && !idf()){
+      irq_pending = false;
+      // if (!nmi_pending) { pending_interrupt = false; };
+      // pending_interrupt = false;
       idf(true);
       pc(load_word(pAddrIRQVector));
     }
     tick(1);
-  }// else { mos6510::irq_pending = false; }; // TODO: TEST THIS!
+  }// else { irq_pending = false; }; // TODO: TEST THIS!
 }
 void mos6510::nmi_(val_t source)
 {
   // if (loginstructions) { dump_regs_irq(1, source); }
-  mos6510::nmi_pending = mos6510::pending_interrupt = true;
+  nmi_pending = pending_interrupt = true;
 }
 
 void mos6510::irq_(val_t source)
 {
   // if (loginstructions && !idf()) { dump_regs_irq(0, source); }
-  mos6510::irq_pending = mos6510::pending_interrupt = true;
+  irq_pending = pending_interrupt = true;
 }
 
 void mos6510::process_interrupts(void)
@@ -1862,31 +2096,27 @@ void __us_not_in_flash_func(brk) mos6510::brk()
   bcf(true);
   push(((pc()+1) >> 8) & 0xff);
   push(((pc()+1) & 0xff));
-  tick(4);
   push(flags()|0x10);  /* brk & php instructions push the bcf flag active */
   // push(flags());  /* brk & php instructions push the bcf flag active */
-  tick(1);
   idf(true);
   pc(load_word(pAddrIRQVector));
-  pc_address = pc_;
   // TODO: Add some kind of alarms processing here
-  // if (mos6510::nmi_pending) {
+  // if (nmi_pending) {
   //   idf(true);
   //   pc(load_word(Memory::pAddrNMIVector));
-  //   mos6510::nmi_pending = false;
-  //   // mos6510::pending_interrupt = false;
-  //   // if (!mos6510::irq_pending/) { mos6510::pending_interrupt = false; };
-  // } else if (mos6510::irq_pending && !idf()) {
+  //   nmi_pending = false;
+  //   // pending_interrupt = false;
+  //   // if (!irq_pending/) { pending_interrupt = false; };
+  // } else if (irq_pending && !idf()) {
   //   idf(true);
   //   pc(load_word(Memory::pAddrIRQVector));
-  //   mos6510::irq_pending = false;
-  //   // mos6510::pending_interrupt = false;
-  //   if (!mos6510::nmi_pending) { mos6510::pending_interrupt = false; };
+  //   irq_pending = false;
+  //   // pending_interrupt = false;
+  //   if (!nmi_pending) { pending_interrupt = false; };
   // } else {
   //   idf(true);
   //   pc(load_word(Memory::pAddrIRQVector));
   // }
-  tick(2);
 }
 
 /**
@@ -1909,7 +2139,6 @@ void __us_not_in_flash_func(irq) mos6510::irq(uint_least8_t source)
     pc(load_word(pAddrIRQVector));
     idf(true);
     tick(2);
-    pc_address = pc_;
     // tick(7);
   }
 }
@@ -1931,7 +2160,6 @@ void __us_not_in_flash_func(nmi) mos6510::nmi(uint_least8_t source)
   push((flags() & 0xef));
   pc(load_word(pAddrNMIVector));
   tick(2);
-  pc_address = pc_;
   // tick(7);
 }
 
@@ -2017,24 +2245,71 @@ void mos6510::dump_regs()
 #endif
 }
 
-static unsigned long log_num = 0;
+/**
+ * @brief Address the instruction at pc_address is about to read or
+ * write last, resolved before it executes for the instruction log
+ *
+ * Only called by the traced step, keeps the plain path free of debug
+ * address stores. Operands come from the predecode buffer when the
+ * instruction is cached and from RAM otherwise, nothing touches IO.
+ *
+ * @param insn
+ * @return addr_t
+ */
+addr_t mos6510::trace_address(val_t insn)
+{
+  auto operand = [this](uint_least8_t i) -> addr_t {
+    return (ibuf_ ? ibuf_[i] : mmu_->dma_read_ram(pc_ + i));
+  };
+  auto zp_word = [this](addr_t addr) -> addr_t {
+    return (mmu_->dma_read_ram(addr & 0xff) | (mmu_->dma_read_ram((addr + 1) & 0xff) << 8));
+  };
+  const addr_t zp = operand(0);
+  const addr_t abs = (zp | (operand(1) << 8));
+
+  switch (insn) {
+    case 0x00: return (pAddrIRQVector);                           /* BRK, vector fetch */
+    case 0x08: case 0x48: return (pBaseAddrStack + sp_);          /* PHP PHA */
+    case 0x28: case 0x68: return (pBaseAddrStack + ((sp_ + 1) & 0xff)); /* PLP PLA */
+    case 0x20: return (pBaseAddrStack + ((sp_ - 1) & 0xff));     /* JSR, last push */
+    case 0x40: return (pBaseAddrStack + ((sp_ + 3) & 0xff));     /* RTI, last pop */
+    case 0x60: return (pBaseAddrStack + ((sp_ + 2) & 0xff));     /* RTS, last pop */
+    case 0x4C: return pc_;                                        /* JMP abs, operand */
+    default: break;
+  }
+  switch (mos6510_opcodes[insn].mode) {
+    case kImplied:
+    case kAccumulator: return pc_address;
+    case kImmediate:
+    case kRelative:    return pc_;
+    case kZeroPage:    return zp;
+    case kZeroPageX:   return ((zp + x_) & 0xff);
+    case kZeroPageY:   return ((zp + y_) & 0xff);
+    case kAbsolute:
+    case kIndirect:    return abs;
+    case kAbsoluteX:   return (addr_t)(abs + x_);
+    case kAbsoluteY:   return (addr_t)(abs + y_);
+    case kIndirectX:   return zp_word(zp + x_);
+    case kIndirectY:   return (addr_t)(zp_word(zp) + y_);
+  }
+  return pc_address;
+}
 
 void mos6510::dump_regs_insn(val_t insn)
 {
-  static CPUCLOCK prev_cycles = cycles();
-
-  MOSDBG("C%8llu(#%6lu) INSN=%02X '%-9s' PCADDR:$%04x ADDR:$%04x VAL:$%02x CYC=%2u ",
+  MOSDBG("C%8llu(#%6lu) INSN=%02X '%s %-5s' PCADDR:$%04x ADDR:$%04x VAL:$%02x CYC=%2u ",
     cycles_,
-    ++log_num,
+    ++log_num_,
     insn,
-    opcodenames[insn],
+    mos6510_opcodes[insn].mnemonic,
+    addr_mode_names[mos6510_opcodes[insn].mode],
     pc_address, /* Opcode address */
     d_address,  /* Latest read/write address address */
     mmu_->dma_read_ram(d_address), /* READ/WRITE VALUE */
-    (cycles()-prev_cycles));
+    (cycles()-prev_cycles_));
   dump_regs();
   MOSDBG("\n");
-  prev_cycles = cycles();
+  prev_cycles_ = cycles();
   return;
 }
 
@@ -2046,7 +2321,7 @@ void mos6510::dump_regs_irq(uint_least8_t type, uint_least8_t source)
   };
   MOSDBG("C%8u(#%6u) INSN=%02X '%-4s%-5s' PCADDR:$%04x ADDR:$%04x VAL:$%02x CYC=%2u ",
     cycles_,
-    ++log_num,
+    ++log_num_,
     type,
     irq_types[type],
     interrupt_sources[source],
@@ -2070,9 +2345,42 @@ void mos6510::dump_regs_json()
   MOSDBG("}\n");
 }
 
+/**
+ * @brief Disassemble the instruction at addr from RAM
+ *
+ * @param addr
+ * @param buf
+ * @param len
+ * @return val_t instruction length in bytes
+ */
+val_t mos6510::disassemble(addr_t addr, char *buf, size_t len)
+{
+  const opcode_t &op = mos6510_opcodes[mmu_->dma_read_ram(addr)];
+  val_t lo = mmu_->dma_read_ram(addr+1);
+  addr_t w = (lo | (mmu_->dma_read_ram(addr+2) << 8));
+  switch (op.mode) {
+    case kImplied:     snprintf(buf,len,"%s",op.mnemonic); break;
+    case kAccumulator: snprintf(buf,len,"%s A",op.mnemonic); break;
+    case kImmediate:   snprintf(buf,len,"%s #$%02X",op.mnemonic,lo); break;
+    case kZeroPage:    snprintf(buf,len,"%s $%02X",op.mnemonic,lo); break;
+    case kZeroPageX:   snprintf(buf,len,"%s $%02X,X",op.mnemonic,lo); break;
+    case kZeroPageY:   snprintf(buf,len,"%s $%02X,Y",op.mnemonic,lo); break;
+    case kAbsolute:    snprintf(buf,len,"%s $%04X",op.mnemonic,w); break;
+    case kAbsoluteX:   snprintf(buf,len,"%s $%04X,X",op.mnemonic,w); break;
+    case kAbsoluteY:   snprintf(buf,len,"%s $%04X,Y",op.mnemonic,w); break;
+    case kIndirect:    snprintf(buf,len,"%s ($%04X)",op.mnemonic,w); break;
+    case kIndirectX:   snprintf(buf,len,"%s ($%02X,X)",op.mnemonic,lo); break;
+    case kIndirectY:   snprintf(buf,len,"%s ($%02X),Y",op.mnemonic,lo); break;
+    case kRelative:    snprintf(buf,len,"%s $%04X",op.mnemonic,(addr_t)(addr + 2 + (int8_t)lo)); break;
+  }
+  return op.length;
+}
+
 void mos6510::dbg()
 {
-  MOSDBG("INS %02X: %02X %02X %04X\n",load_byte(pc_-1),load_byte(pc_),load_byte(pc_+1),pc_);
+  char insn[16];
+  disassemble(pc_,insn,sizeof(insn));
+  MOSDBG("INS $%04X: %s\n",pc_,insn);
   // MOSDBG("INS-1 %02X: %02X %02X %04X\n",load_byte(pc_-2),load_byte(pc_-1),load_byte(pc_+2),pc_-1);
   // MOSDBG("INS-2 %02X: %02X %02X %04X\n",load_byte(pc_-3),load_byte(pc_-2),load_byte(pc_+3),pc_-2);
 }
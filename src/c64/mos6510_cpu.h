@@ -34,7 +34,6 @@
 
 
 #include <cstdint>
-#include <functional>
 #if DESKTOP
 #include <iostream>
 #include <ios>
@@ -43,6 +42,9 @@
 
 #include <types.h>
 #include <constants.h>
+#include <c64util.h>
+#include <mos6510_opcodes.h>
+#include <scheduler.h>
 
 
 /* These define the position of the status
@@ -62,29 +64,39 @@
 
 /* macro helpers */
 #define SETFLAG(flag, cond) \
-    if (cond) _flags |= (val_t)flag; \
-    else _flags &= ~(val_t)flag;
+    _flags = (val_t)((_flags & ~(val_t)(flag)) | ((val_t)(flag) & -(val_t)!!(cond)));
 #define GETFLAG(flag) (_flags & flag)
 
-#define SET_ZF(val) \
+/**
+ * @brief N and Z flags for every 8 bit result
+ */
+struct nz_flags_t
+{
+  val_t f[0x100];
+};
+
+constexpr nz_flags_t make_nz_flags(void)
+{
+  nz_flags_t t = {};
+  for (unsigned int v = 0; v < 0x100; v++) {
+    t.f[v] = (val_t)((v & SR_NEGATIVE) | (v == 0 ? SR_ZERO : 0));
+  }
+  return t;
+}
+
+inline constexpr nz_flags_t mos6510_nz_flags = make_nz_flags();
+
+#define SET_NZ(val) \
   do { \
-    if (!(val_t)(val)) { \
-      SETFLAG(SR_ZERO, 1) \
-    } else { \
-      SETFLAG(SR_ZERO, 0 ) \
-    } \
+    _flags = (val_t)((_flags & ~(SR_NEGATIVE|SR_ZERO)) | mos6510_nz_flags.f[(val_t)(val)]); \
   } while(0)
-#define SET_OF(val) \
+#define SET_ZF(val) \
   do { \
-    if (((val_t)(val)&0x40)!=0) { \
-      SETFLAG(SR_OVERFLOW, 1) \
-    } else { \
-      SETFLAG(SR_OVERFLOW, 0) \
-    } \
+    _flags = (val_t)((_flags & ~SR_ZERO) | (mos6510_nz_flags.f[(val_t)(val)] & SR_ZERO)); \
   } while(0)
-#define SET_NF(val) do { if (((val_t)(val)&0x80)!=0) { SETFLAG(SR_NEGATIVE, 1) } else { SETFLAG(SR_NEGATIVE, 0) } } while(0)
-#define SET_CF(val) do { if (((val_t)(val)&0x100)!=0) { SETFLAG(SR_CARRY, 1) } else { SETFLAG(SR_CARRY, 0) } } while(0)
-
+#define SET_OF(val) do { _flags = (val_t)((_flags & ~SR_OVERFLOW) | ((val_t)(val) & SR_OVERFLOW)); } while(0)
+#define SET_NF(val) do { _flags = (val_t)((_flags & ~SR_NEGATIVE) | ((val_t)(val) & SR_NEGATIVE)); } while(0)
+#define SET_CF(val) do { _flags = (val_t)((_flags & ~SR_CARRY) | (((val) >> 8) & SR_CARRY)); } while(0)
 
 class mmu;
 class mos6560_6561;
@@ -96,33 +108,6 @@ class mos6526;
  */
 class mos6510
 {
-  protected:
-    const char * opcodenames[0x100] = { /* For debug logging */
-      "BRK impl", "ORA X,ind", "JAM", "SLO X,ind", "NOP zpg", "ORA zpg", "ASL zpg", "SLO zpg", "PHP impl", "ORA #", "ASL A", "ANC #", "NOP abs", "ORA abs", "ASL abs", "SLO abs",
-      "BPL rel", "ORA ind,Y", "JAM", "SLO ind,Y", "NOP zpg,X", "ORA zpg,X", "ASL zpg,X", "SLO zpg,X", "CLC impl", "ORA abs,Y", "NOP impl", "SLO abs,Y", "NOP abs,X", "ORA abs,X", "ASL abs,X", "SLO abs,X",
-      "JSR abs", "AND X,ind", "JAM", "RLA X,ind", "BIT zpg", "AND zpg", "ROL zpg", "RLA zpg", "PLP impl", "AND #", "ROL A", "ANC #", "BIT abs", "AND abs", "ROL abs", "RLA abs",
-      "BMI rel", "AND ind,Y", "JAM", "RLA ind,Y", "NOP zpg,X", "AND zpg,X", "ROL zpg,X", "RLA zpg,X", "SEC impl", "AND abs,Y", "NOP impl", "RLA abs,Y", "NOP abs,X", "AND abs,X", "ROL abs,X", "RLA abs,X",
-      "RTI impl", "EOR X,ind", "JAM", "SRE X,ind", "NOP zpg", "EOR zpg", "LSR zpg", "SRE zpg", "PHA impl", "EOR #", "LSR A", "ALR #", "JMP abs", "EOR abs", "LSR abs", "SRE abs",
-      "BVC rel", "EOR ind,Y", "JAM", "SRE ind,Y", "NOP zpg,X", "EOR zpg,X", "LSR zpg,X", "SRE zpg,X", "CLI impl", "EOR abs,Y", "NOP impl", "SRE abs,Y", "NOP abs,X", "EOR abs,X", "LSR abs,X", "SRE abs,X",
-      "RTS impl", "ADC X,ind", "JAM", "RRA X,ind", "NOP zpg", "ADC zpg", "ROR zpg", "RRA zpg", "PLA impl", "ADC #", "ROR A", "ARR #", "JMP ind", "ADC abs", "ROR abs", "RRA abs",
-      "BVS rel", "ADC ind,Y", "JAM", "RRA ind,Y", "NOP zpg,X", "ADC zpg,X", "ROR zpg,X", "RRA zpg,X", "SEI impl", "ADC abs,Y", "NOP impl", "RRA abs,Y", "NOP abs,X", "ADC abs,X", "ROR abs,X", "RRA abs,X",
-      "NOP #", "STA X,ind", "NOP #", "SAX X,ind", "STY zpg", "STA zpg", "STX zpg", "SAX zpg", "DEY impl", "NOP #", "TXA impl", "ANE #", "STY abs", "STA abs", "STX abs", "SAX abs",
-      "BCC rel", "STA ind,Y", "JAM", "SHA ind,Y", "STY zpg,X", "STA zpg,X", "STX zpg,Y", "SAX zpg,Y", "TYA impl", "STA abs,Y", "TXS impl", "TAS abs,Y", "SHY abs,X", "STA abs,X", "SHX abs,Y", "SHA abs,Y",
-      "LDY #", "LDA X,ind", "LDX #", "LAX X,ind", "LDY zpg", "LDA zpg", "LDX zpg", "LAX zpg", "TAY impl", "LDA #", "TAX impl", "LXA #", "LDY abs", "LDA abs", "LDX abs", "LAX abs",
-      "BCS rel", "LDA ind,Y", "JAM", "LAX ind,Y", "LDY zpg,X", "LDA zpg,X", "LDX zpg,Y", "LAX zpg,Y", "CLV impl", "LDA abs,Y", "TSX impl", "LAS abs,Y", "LDY abs,X", "LDA abs,X", "LDX abs,Y", "LAX abs,Y",
-      "CPY #", "CMP X,ind", "NOP #", "DCP X,ind", "CPY zpg", "CMP zpg", "DEC zpg", "DCP zpg", "INY impl", "CMP #", "DEX impl", "SBX #", "CPY abs", "CMP abs", "DEC abs", "DCP abs",
-      "BNE rel", "CMP ind,Y", "JAM", "DCP ind,Y", "NOP zpg,X", "CMP zpg,X", "DEC zpg,X", "DCP zpg,X", "CLD impl", "CMP abs,Y", "NOP impl", "DCP abs,Y", "NOP abs,X", "CMP abs,X", "DEC abs,X", "DCP abs,X",
-      "CPX #", "SBC X,ind", "NOP #", "ISC X,ind", "CPX zpg", "SBC zpg", "INC zpg", "ISC zpg", "INX impl", "SBC #", "NOP impl", "USBC #", "CPX abs", "SBC abs", "INC abs", "ISC abs",
-      "BEQ rel", "SBC ind,Y", "JAM", "ISC ind,Y", "NOP zpg,X", "SBC zpg,X", "INC zpg,X", "ISC zpg,X", "SED impl", "SBC abs,Y", "NOP impl", "ISC abs,Y", "NOP abs,X", "SBC abs,X", "INC abs,X", "ISC abs, X",
-    };
-
-    /* Define the type for the lookup table entries
-       Force all entries to a uniform call signature: void(),
-       binding any necessary parameters internally. */
-    using InstructionHandler = std::function<void()>;
-
-    /* The lookup table for 256 opcodes */
-    std::array<InstructionHandler, 256> instruction_table;
   private: /* TODO: Group instructions by memory type */
     /* Glue */
     mmu * mmu_;
@@ -140,13 +125,20 @@ class mos6510
     val_t _flags = 0b11111111;
 
     /* c64->memory and clock */
-    static CPUCLOCK cycles_;
-    static CPUCLOCK prev_cycles_;
+    CPUCLOCK cycles_ = 0;
+    CPUCLOCK prev_cycles_ = 0;
 
     /* helpers */
     addr_t curr_page; /* current page at start of cpu emulation */
     bool pb_crossed;    /* true if page boundary crossed */
 
+    /* Direct RAM access, zero page and stack from $0002 and opcode fetches
+     * from pages that never bank out skip the bus, $00/$01 is the cpu port */
+    val_t * ram_ = nullptr;
+    addr_t ram_span_ = 0; /* 0 disables, else 0x1fe for $0002/$01ff */
+    inline bool ram_fetch(addr_t addr);
+    inline val_t fetch_byte(addr_t addr);
+
     inline void save_byte(addr_t addr, val_t val);
     inline val_t load_byte(addr_t addr);
     inline addr_t load_word(addr_t addr);
@@ -162,18 +154,20 @@ class mos6510
     inline addr_t addr_absx();
     inline addr_t addr_indx();
     inline addr_t addr_indy();
+    template<val_t op> inline addr_t ea(void);
+    template<val_t op> inline val_t operand(void);
 
     inline val_t rol(val_t v);
     inline val_t ror(val_t v);
     inline val_t lsr(val_t v);
     inline val_t asl(val_t v);
     /* instructions : data handling and memory operations */
-    inline void sta(addr_t addr, cycle_t cycles);
-    inline void stx(addr_t addr, cycle_t cycles);
-    inline void sty(addr_t addr, cycle_t cycles);
-    inline void lda(val_t v, cycle_t cycles);
-    inline void ldx(val_t v, cycle_t cycles);
-    inline void ldy(val_t v, cycle_t cycles);
+    inline void sta(addr_t addr);
+    inline void stx(addr_t addr);
+    inline void sty(addr_t addr);
+    inline void lda(val_t v);
+    inline void ldx(val_t v);
+    inline void ldy(val_t v);
     inline void txs();
     inline void tsx();
     inline void tax();
@@ -183,27 +177,27 @@ class mos6510
     inline void pha();
     inline void pla();
     /* instructions: logic operations */
-    inline void ora(val_t v, cycle_t cycles);
-    inline void _and(val_t v, cycle_t cycles);
-    inline void bit(addr_t addr, cycle_t cycles);
+    inline void ora(val_t v);
+    inline void _and(val_t v);
+    inline void bit(addr_t addr);
     inline void rol_a();
-    inline void rol_mem(addr_t addr, cycle_t cycles);
+    inline void rol_mem(addr_t addr);
     inline void ror_a();
-    inline void ror_mem(addr_t addr, cycle_t cycles);
+    inline void ror_mem(addr_t addr);
     inline void asl_a();
-    inline void asl_mem(addr_t addr, cycle_t cycles);
+    inline void asl_mem(addr_t addr);
     inline void lsr_a();
-    inline void lsr_mem(addr_t addr, cycle_t cycles);
-    inline void eor(val_t v, cycle_t cycles);
+    inline void lsr_mem(addr_t addr);
+    inline void eor(val_t v);
     /* instructions: arithmetic operations */
-    inline void inc(addr_t addr, cycle_t cycles);
-    inline void dec(addr_t addr, cycle_t cycles);
+    inline void inc(addr_t addr);
+    inline void dec(addr_t addr);
     inline void inx();
     inline void iny();
     inline void dex();
     inline void dey();
-    inline void adc(val_t v, cycle_t cycles);
-    inline void sbc(val_t v, cycle_t cycles);
+    inline void adc(val_t v);
+    inline void sbc(val_t v);
     /* instructions: flag access */
     inline void sei();
     inline void cli();
@@ -215,45 +209,36 @@ class mos6510
     inline void php();
     inline void plp();
     /* instructions: control flow */
-    inline void cmp(val_t v, cycle_t cycles);
-    inline void cpx(val_t v, cycle_t cycles);
-    inline void cpy(val_t v, cycle_t cycles);
+    inline void cmp(val_t v);
+    inline void cpx(val_t v);
+    inline void cpy(val_t v);
     inline void rts();
     inline void jsr();
-    inline void bne();
-    inline void beq();
-    inline void bcs();
-    inline void bcc();
-    inline void bpl();
-    inline void bmi();
-    inline void bvc();
-    inline void bvs();
+    inline void branch(bool cond);
     inline void jmp();
     inline void jmp_ind();
     /* instructions: misc */
-    inline void nop(cycle_t cycles);
     inline void brk();
     inline void rti();
     /* Instructions: illegal */
     inline void jam(val_t insn);
-    inline void slo(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void lxa(val_t v, cycle_t cycles);
+    inline void slo(addr_t addr);
+    inline void lxa(val_t v);
     inline void anc(val_t v);
     inline void las(val_t v);
-    inline void lax(val_t v, cycle_t cycles);
-    inline void shy(addr_t addr, cycle_t cycles);
-    inline void shx(addr_t addr, cycle_t cycles);
-    inline void sha(addr_t addr, cycle_t cycles);
-    inline void sax(addr_t addr, cycle_t cycles);
-    inline void sre(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void rla(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void rla_(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void rra(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void dcp(addr_t addr, cycle_t cycles_a, cycle_t cycles_b);
-    inline void tas(addr_t addr, cycle_t cycles);
-    inline void sbx(val_t v, cycle_t cycles);
-    inline void isc(addr_t addr, cycle_t cycles);
-    inline void arr();
+    inline void lax(val_t v);
+    inline void shy(addr_t addr);
+    inline void shx(addr_t addr);
+    inline void sha(addr_t addr);
+    inline void sax(addr_t addr);
+    inline void sre(addr_t addr);
+    inline void rla(addr_t addr);
+    inline void rra(addr_t addr);
+    inline void dcp(addr_t addr);
+    inline void tas(addr_t addr);
+    inline void sbx(val_t v);
+    inline void isc(addr_t addr);
+    inline void arr(val_t v);
     inline void xaa(val_t v);
 
     typedef void (*BusWrite)(addr_t, val_t);
@@ -267,6 +252,77 @@ class mos6510
     CPUCLOCK cia1_timb_irq_callback = 0;
     CPUCLOCK cia2_tima_nmi_callback = 0;
     CPUCLOCK cia2_timb_nmi_callback = 0;
+
+    /* Predecode cache
+     * Per page store of the opcode (which selects the handler in
+     * execute) and its operand bytes, allocated on first use */
+    struct predecode_page_t {
+      uint64_t valid[4];     /* one bit per page offset */
+      val_t insn[0x100][3];  /* opcode, operand lo, operand hi */
+    };
+    predecode_page_t * predecode_[0x100] = {};
+    const val_t * ibuf_ = nullptr; /* predecoded bytes of the current instruction */
+    inline const val_t * predecode(addr_t addr);
+  public:
+    /* Predecode cache statistics */
+    struct predecode_stats_t {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t invalidations; /* writes that dropped cached instructions */
+      uint64_t flushes;       /* page ranges dropped on bank switching */
+    };
+  private:
+    predecode_stats_t predecode_stats_ = {};
+
+    /* Superblocks
+     * Straight line runs of instructions translated into handlers
+     * bound to their opcode with the operand bytes and the summed
+     * base cycles. A run ends before any instruction that branches,
+     * changes the interrupt flag or might access IO so that those
+     * always start a new call with the peripherals caught up */
+    static const int kSuperblockMaxInsns = 16;
+    typedef void (*SuperblockHandler)(mos6510*);
+    struct superblock_insn_t {
+      SuperblockHandler fn;
+      addr_t pc;               /* address of the opcode */
+      val_t bytes[3];          /* opcode, operand lo, operand hi */
+      bool pb_penalty;
+      cycle_t cycles;          /* base cycles up to and including this instruction */
+    };
+    struct superblock_t {
+      uint_least32_t gen[2];   /* page generations of the first and last byte at translation */
+      addr_t first_page, last_page;
+      uint_least8_t count;     /* 0 ~ instruction at start can't be translated, interpret it */
+      superblock_insn_t insn[kSuperblockMaxInsns];
+    };
+    superblock_t ** superblocks_[0x100] = {};   /* per page, per start offset */
+    uint_least32_t superblock_gen_[0x100] = {}; /* bumped when translated code in a page changes */
+    uint64_t superblock_code_[0x100][4] = {};   /* bytes covered by translations per page */
+    uint_least32_t superblock_invalidations_ = 0;
+    template<val_t op> static void superblock_handler(mos6510 * cpu);
+    inline bool superblock_ends(val_t opcode, addr_t operand);
+    inline void superblock_mark(addr_t addr);
+    superblock_t * superblock(addr_t addr);
+
+    /* Idle loops */
+    static const addr_t kIdleLoopMaxBytes = 16;
+    bool idle_loop_ = false;  /* idle_pc_ holds a possible idle loop */
+    addr_t idle_pc_ = 0;
+    uint64_t idle_skipped_cycles_ = 0;
+    uint64_t idle_skips_ = 0;
+    inline void idle_candidate(addr_t addr);
+    bool idle_skip(void);
+  public:
+    /* Superblock statistics */
+    struct superblock_stats_t {
+      uint64_t translations;
+      uint64_t runs;          /* superblocks executed */
+      uint64_t insns;         /* instructions executed from superblocks */
+      uint64_t aborts;        /* runs cut short by a write to translated code */
+      uint64_t invalidations;
+    };
+  private:
+    superblock_stats_t superblock_stats_ = {};
   public:
     mos6510(BusRead r, BusWrite w);
     ~mos6510(void);
@@ -281,21 +337,49 @@ class mos6510
     /* https://stackoverflow.com/questions/16418242/checking-whether-callback-is-set-by-the-client-in-c */
     bool check_callback(void) { return (clock_cycle != nullptr); };
 
-    /* Static variables */
-    static bool pending_interrupt;
-    static bool irq_pending;
-    static bool nmi_pending;
+    /* Peripheral alarms, dispatched by the machine loop */
+    scheduler alarms;
+
+    /* Interrupt state */
+    bool pending_interrupt = false;
+    bool irq_pending = false;
+    bool nmi_pending = false;
 
     /* cpu state */
     void reset(void);
     void hot_reset(void);
     bool emulate(void);
+    template<class Trace> bool step(void);
     bool emulate_n(tick_t n_cycles);
     inline void stall_cpu(bool stall) { vic_stall_cpu_ = stall; };
 
+    /* predecode cache */
+#if DESKTOP
+    bool predecode_enabled = true;
+#elif EMBEDDED
+    bool predecode_enabled = false; /* Up to 200kB when fully populated */
+#endif
+    void direct_ram(bool enable);
+    void predecode_invalidate(addr_t addr);
+    void predecode_flush(val_t first_page, val_t last_page);
+    const predecode_stats_t &predecode_stats(void) { return predecode_stats_; };
+    void dump_predecode_stats(void);
+
+    /* idle loops */
+    bool idle_skip_enabled = true;
+    CPUCLOCK idle_limit = RUN_FOREVER; /* Skips end at or before this cycle, the run loop budget */
+    uint64_t idle_skipped_cycles(void) { return idle_skipped_cycles_; };
+
+    /* superblocks */
+    bool superblocks_enabled = false;
+    bool emulate_block(void);
+    void superblock_flush(void);
+    const superblock_stats_t &superblock_stats(void) { return superblock_stats_; };
+    void dump_superblock_stats(void);
+
     /* register access */
     inline addr_t pc() { return pc_; };
-    inline void pc(addr_t v) { pc_=v; pc_address = pc_; };
+    inline void pc(addr_t v) { pc_=v; };
     inline val_t sp() { return sp_; };
     inline void sp(val_t v) { sp_=v; };
     inline val_t a() { return a_; };
@@ -327,9 +411,8 @@ class mos6510
     void cycles(CPUCLOCK v);
     void tickle_me(cycle_t v);
   private:
-    bool initialized = false;
-    void fill_instruction_table(void);
-    void execute(uint8_t opcode);
+    inline void execute(val_t opcode);
+    inline void dispatch(val_t opcode);
 
     inline void tick_backup(cycle_t v);
     inline void tick(cycle_t v);
@@ -348,16 +431,19 @@ class mos6510
     void process_interrupts(void);
 
     /* debug */
-    static bool loginstructions;
-    static val_t last_insn;
-    static addr_t pc_address; /* debug printing helper */
-    static addr_t d_address;  /* debug printing helper */
+    bool loginstructions = false;
+    val_t last_insn = 0;
+    addr_t pc_address = 0; /* debug printing helper, only kept by the traced step */
+    addr_t d_address = 0;  /* debug printing helper, only kept by the traced step */
+    unsigned long log_num_ = 0;
     void dump_flags();
     void dump_flags(val_t flags);
     void dump_regs();
+    addr_t trace_address(val_t insn);
     void dump_regs_insn(val_t insn);
     void dump_regs_irq(val_t type, val_t source);
     void dump_regs_json();
+    val_t disassemble(addr_t addr, char *buf, size_t len);
     void dbg();
     void dbg_a();
     void dbg_b();
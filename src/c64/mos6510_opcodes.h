@@ -0,0 +1,364 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid, SidBerry and emudore/adorable
+ *
+ * mos6510_opcodes.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MOS6510_OPCODES_H
+#define _MOS6510_OPCODES_H
+
+
+#include <cstdint>
+
+#include <types.h>
+
+
+/**
+ * @brief 6510 addressing modes
+ */
+enum AddrMode : uint8_t
+{
+  kImplied = 0,  /* impl  */
+  kAccumulator,  /* A     */
+  kImmediate,    /* #     */
+  kZeroPage,     /* zpg   */
+  kZeroPageX,    /* zpg,X */
+  kZeroPageY,    /* zpg,Y */
+  kAbsolute,     /* abs   */
+  kAbsoluteX,    /* abs,X */
+  kAbsoluteY,    /* abs,Y */
+  kIndirect,     /* ind   */
+  kIndirectX,    /* X,ind */
+  kIndirectY,    /* ind,Y */
+  kRelative,     /* rel   */
+};
+
+/* Addressing mode names for debug logging, indexed by AddrMode */
+inline constexpr const char * addr_mode_names[] = {
+  "impl", "A", "#", "zpg", "zpg,X", "zpg,Y", "abs", "abs,X", "abs,Y", "ind", "X,ind", "ind,Y", "rel",
+};
+
+/**
+ * @brief Opcode descriptor
+ *
+ * One entry per opcode holding the addressing mode, base cycle
+ * count, page boundary penalty, length and mnemonic. Used by the
+ * cpu dispatch and cycle accounting, the disassembler and the logger
+ */
+struct opcode_t
+{
+  const char * mnemonic;
+  AddrMode mode;
+  cycle_t cycles;        /* base cycles */
+  bool pb_penalty;       /* +1 cycle if the effective address crosses a page boundary */
+  uint_least8_t length;  /* instruction length in bytes including the opcode */
+};
+
+/**
+ * @brief The 6510 opcode table
+ *
+ * Cycle counts follow the NMOS 6510 including the undocumented opcodes,
+ * branches add their taken/page crossing cycles on top of the base count
+ */
+inline constexpr opcode_t mos6510_opcodes[0x100] = {
+  /* 0x00 ~ 0x0F */
+  { "BRK",  kImplied,      7, false, 1 }, /* 0x00 */
+  { "ORA",  kIndirectX,    6, false, 2 }, /* 0x01 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x02 */
+  { "SLO",  kIndirectX,    8, false, 2 }, /* 0x03 */
+  { "NOP",  kZeroPage,     3, false, 2 }, /* 0x04 */
+  { "ORA",  kZeroPage,     3, false, 2 }, /* 0x05 */
+  { "ASL",  kZeroPage,     5, false, 2 }, /* 0x06 */
+  { "SLO",  kZeroPage,     5, false, 2 }, /* 0x07 */
+  { "PHP",  kImplied,      3, false, 1 }, /* 0x08 */
+  { "ORA",  kImmediate,    2, false, 2 }, /* 0x09 */
+  { "ASL",  kAccumulator,  2, false, 1 }, /* 0x0A */
+  { "ANC",  kImmediate,    2, false, 2 }, /* 0x0B */
+  { "NOP",  kAbsolute,     4, false, 3 }, /* 0x0C */
+  { "ORA",  kAbsolute,     4, false, 3 }, /* 0x0D */
+  { "ASL",  kAbsolute,     6, false, 3 }, /* 0x0E */
+  { "SLO",  kAbsolute,     6, false, 3 }, /* 0x0F */
+  /* 0x10 ~ 0x1F */
+  { "BPL",  kRelative,     2, false, 2 }, /* 0x10 */
+  { "ORA",  kIndirectY,    5, true,  2 }, /* 0x11 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x12 */
+  { "SLO",  kIndirectY,    8, false, 2 }, /* 0x13 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0x14 */
+  { "ORA",  kZeroPageX,    4, false, 2 }, /* 0x15 */
+  { "ASL",  kZeroPageX,    6, false, 2 }, /* 0x16 */
+  { "SLO",  kZeroPageX,    6, false, 2 }, /* 0x17 */
+  { "CLC",  kImplied,      2, false, 1 }, /* 0x18 */
+  { "ORA",  kAbsoluteY,    4, true,  3 }, /* 0x19 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0x1A */
+  { "SLO",  kAbsoluteY,    7, false, 3 }, /* 0x1B */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0x1C */
+  { "ORA",  kAbsoluteX,    4, true,  3 }, /* 0x1D */
+  { "ASL",  kAbsoluteX,    7, false, 3 }, /* 0x1E */
+  { "SLO",  kAbsoluteX,    7, false, 3 }, /* 0x1F */
+  /* 0x20 ~ 0x2F */
+  { "JSR",  kAbsolute,     6, false, 3 }, /* 0x20 */
+  { "AND",  kIndirectX,    6, false, 2 }, /* 0x21 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x22 */
+  { "RLA",  kIndirectX,    8, false, 2 }, /* 0x23 */
+  { "BIT",  kZeroPage,     3, false, 2 }, /* 0x24 */
+  { "AND",  kZeroPage,     3, false, 2 }, /* 0x25 */
+  { "ROL",  kZeroPage,     5, false, 2 }, /* 0x26 */
+  { "RLA",  kZeroPage,     5, false, 2 }, /* 0x27 */
+  { "PLP",  kImplied,      4, false, 1 }, /* 0x28 */
+  { "AND",  kImmediate,    2, false, 2 }, /* 0x29 */
+  { "ROL",  kAccumulator,  2, false, 1 }, /* 0x2A */
+  { "ANC",  kImmediate,    2, false, 2 }, /* 0x2B */
+  { "BIT",  kAbsolute,     4, false, 3 }, /* 0x2C */
+  { "AND",  kAbsolute,     4, false, 3 }, /* 0x2D */
+  { "ROL",  kAbsolute,     6, false, 3 }, /* 0x2E */
+  { "RLA",  kAbsolute,     6, false, 3 }, /* 0x2F */
+  /* 0x30 ~ 0x3F */
+  { "BMI",  kRelative,     2, false, 2 }, /* 0x30 */
+  { "AND",  kIndirectY,    5, true,  2 }, /* 0x31 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x32 */
+  { "RLA",  kIndirectY,    8, false, 2 }, /* 0x33 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0x34 */
+  { "AND",  kZeroPageX,    4, false, 2 }, /* 0x35 */
+  { "ROL",  kZeroPageX,    6, false, 2 }, /* 0x36 */
+  { "RLA",  kZeroPageX,    6, false, 2 }, /* 0x37 */
+  { "SEC",  kImplied,      2, false, 1 }, /* 0x38 */
+  { "AND",  kAbsoluteY,    4, true,  3 }, /* 0x39 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0x3A */
+  { "RLA",  kAbsoluteY,    7, false, 3 }, /* 0x3B */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0x3C */
+  { "AND",  kAbsoluteX,    4, true,  3 }, /* 0x3D */
+  { "ROL",  kAbsoluteX,    7, false, 3 }, /* 0x3E */
+  { "RLA",  kAbsoluteX,    7, false, 3 }, /* 0x3F */
+  /* 0x40 ~ 0x4F */
+  { "RTI",  kImplied,      6, false, 1 }, /* 0x40 */
+  { "EOR",  kIndirectX,    6, false, 2 }, /* 0x41 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x42 */
+  { "SRE",  kIndirectX,    8, false, 2 }, /* 0x43 */
+  { "NOP",  kZeroPage,     3, false, 2 }, /* 0x44 */
+  { "EOR",  kZeroPage,     3, false, 2 }, /* 0x45 */
+  { "LSR",  kZeroPage,     5, false, 2 }, /* 0x46 */
+  { "SRE",  kZeroPage,     5, false, 2 }, /* 0x47 */
+  { "PHA",  kImplied,      3, false, 1 }, /* 0x48 */
+  { "EOR",  kImmediate,    2, false, 2 }, /* 0x49 */
+  { "LSR",  kAccumulator,  2, false, 1 }, /* 0x4A */
+  { "ALR",  kImmediate,    2, false, 2 }, /* 0x4B */
+  { "JMP",  kAbsolute,     3, false, 3 }, /* 0x4C */
+  { "EOR",  kAbsolute,     4, false, 3 }, /* 0x4D */
+  { "LSR",  kAbsolute,     6, false, 3 }, /* 0x4E */
+  { "SRE",  kAbsolute,     6, false, 3 }, /* 0x4F */
+  /* 0x50 ~ 0x5F */
+  { "BVC",  kRelative,     2, false, 2 }, /* 0x50 */
+  { "EOR",  kIndirectY,    5, true,  2 }, /* 0x51 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x52 */
+  { "SRE",  kIndirectY,    8, false, 2 }, /* 0x53 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0x54 */
+  { "EOR",  kZeroPageX,    4, false, 2 }, /* 0x55 */
+  { "LSR",  kZeroPageX,    6, false, 2 }, /* 0x56 */
+  { "SRE",  kZeroPageX,    6, false, 2 }, /* 0x57 */
+  { "CLI",  kImplied,      2, false, 1 }, /* 0x58 */
+  { "EOR",  kAbsoluteY,    4, true,  3 }, /* 0x59 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0x5A */
+  { "SRE",  kAbsoluteY,    7, false, 3 }, /* 0x5B */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0x5C */
+  { "EOR",  kAbsoluteX,    4, true,  3 }, /* 0x5D */
+  { "LSR",  kAbsoluteX,    7, false, 3 }, /* 0x5E */
+  { "SRE",  kAbsoluteX,    7, false, 3 }, /* 0x5F */
+  /* 0x60 ~ 0x6F */
+  { "RTS",  kImplied,      6, false, 1 }, /* 0x60 */
+  { "ADC",  kIndirectX,    6, false, 2 }, /* 0x61 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x62 */
+  { "RRA",  kIndirectX,    8, false, 2 }, /* 0x63 */
+  { "NOP",  kZeroPage,     3, false, 2 }, /* 0x64 */
+  { "ADC",  kZeroPage,     3, false, 2 }, /* 0x65 */
+  { "ROR",  kZeroPage,     5, false, 2 }, /* 0x66 */
+  { "RRA",  kZeroPage,     5, false, 2 }, /* 0x67 */
+  { "PLA",  kImplied,      4, false, 1 }, /* 0x68 */
+  { "ADC",  kImmediate,    2, false, 2 }, /* 0x69 */
+  { "ROR",  kAccumulator,  2, false, 1 }, /* 0x6A */
+  { "ARR",  kImmediate,    2, false, 2 }, /* 0x6B */
+  { "JMP",  kIndirect,     5, false, 3 }, /* 0x6C */
+  { "ADC",  kAbsolute,     4, false, 3 }, /* 0x6D */
+  { "ROR",  kAbsolute,     6, false, 3 }, /* 0x6E */
+  { "RRA",  kAbsolute,     6, false, 3 }, /* 0x6F */
+  /* 0x70 ~ 0x7F */
+  { "BVS",  kRelative,     2, false, 2 }, /* 0x70 */
+  { "ADC",  kIndirectY,    5, true,  2 }, /* 0x71 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x72 */
+  { "RRA",  kIndirectY,    8, false, 2 }, /* 0x73 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0x74 */
+  { "ADC",  kZeroPageX,    4, false, 2 }, /* 0x75 */
+  { "ROR",  kZeroPageX,    6, false, 2 }, /* 0x76 */
+  { "RRA",  kZeroPageX,    6, false, 2 }, /* 0x77 */
+  { "SEI",  kImplied,      2, false, 1 }, /* 0x78 */
+  { "ADC",  kAbsoluteY,    4, true,  3 }, /* 0x79 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0x7A */
+  { "RRA",  kAbsoluteY,    7, false, 3 }, /* 0x7B */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0x7C */
+  { "ADC",  kAbsoluteX,    4, true,  3 }, /* 0x7D */
+  { "ROR",  kAbsoluteX,    7, false, 3 }, /* 0x7E */
+  { "RRA",  kAbsoluteX,    7, false, 3 }, /* 0x7F */
+  /* 0x80 ~ 0x8F */
+  { "NOP",  kImmediate,    2, false, 2 }, /* 0x80 */
+  { "STA",  kIndirectX,    6, false, 2 }, /* 0x81 */
+  { "NOP",  kImmediate,    2, false, 2 }, /* 0x82 */
+  { "SAX",  kIndirectX,    6, false, 2 }, /* 0x83 */
+  { "STY",  kZeroPage,     3, false, 2 }, /* 0x84 */
+  { "STA",  kZeroPage,     3, false, 2 }, /* 0x85 */
+  { "STX",  kZeroPage,     3, false, 2 }, /* 0x86 */
+  { "SAX",  kZeroPage,     3, false, 2 }, /* 0x87 */
+  { "DEY",  kImplied,      2, false, 1 }, /* 0x88 */
+  { "NOP",  kImmediate,    2, false, 2 }, /* 0x89 */
+  { "TXA",  kImplied,      2, false, 1 }, /* 0x8A */
+  { "ANE",  kImmediate,    2, false, 2 }, /* 0x8B */
+  { "STY",  kAbsolute,     4, false, 3 }, /* 0x8C */
+  { "STA",  kAbsolute,     4, false, 3 }, /* 0x8D */
+  { "STX",  kAbsolute,     4, false, 3 }, /* 0x8E */
+  { "SAX",  kAbsolute,     4, false, 3 }, /* 0x8F */
+  /* 0x90 ~ 0x9F */
+  { "BCC",  kRelative,     2, false, 2 }, /* 0x90 */
+  { "STA",  kIndirectY,    6, false, 2 }, /* 0x91 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0x92 */
+  { "SHA",  kIndirectY,    6, false, 2 }, /* 0x93 */
+  { "STY",  kZeroPageX,    4, false, 2 }, /* 0x94 */
+  { "STA",  kZeroPageX,    4, false, 2 }, /* 0x95 */
+  { "STX",  kZeroPageY,    4, false, 2 }, /* 0x96 */
+  { "SAX",  kZeroPageY,    4, false, 2 }, /* 0x97 */
+  { "TYA",  kImplied,      2, false, 1 }, /* 0x98 */
+  { "STA",  kAbsoluteY,    5, false, 3 }, /* 0x99 */
+  { "TXS",  kImplied,      2, false, 1 }, /* 0x9A */
+  { "TAS",  kAbsoluteY,    5, false, 3 }, /* 0x9B */
+  { "SHY",  kAbsoluteX,    5, false, 3 }, /* 0x9C */
+  { "STA",  kAbsoluteX,    5, false, 3 }, /* 0x9D */
+  { "SHX",  kAbsoluteY,    5, false, 3 }, /* 0x9E */
+  { "SHA",  kAbsoluteY,    5, false, 3 }, /* 0x9F */
+  /* 0xA0 ~ 0xAF */
+  { "LDY",  kImmediate,    2, false, 2 }, /* 0xA0 */
+  { "LDA",  kIndirectX,    6, false, 2 }, /* 0xA1 */
+  { "LDX",  kImmediate,    2, false, 2 }, /* 0xA2 */
+  { "LAX",  kIndirectX,    6, false, 2 }, /* 0xA3 */
+  { "LDY",  kZeroPage,     3, false, 2 }, /* 0xA4 */
+  { "LDA",  kZeroPage,     3, false, 2 }, /* 0xA5 */
+  { "LDX",  kZeroPage,     3, false, 2 }, /* 0xA6 */
+  { "LAX",  kZeroPage,     3, false, 2 }, /* 0xA7 */
+  { "TAY",  kImplied,      2, false, 1 }, /* 0xA8 */
+  { "LDA",  kImmediate,    2, false, 2 }, /* 0xA9 */
+  { "TAX",  kImplied,      2, false, 1 }, /* 0xAA */
+  { "LXA",  kImmediate,    2, false, 2 }, /* 0xAB */
+  { "LDY",  kAbsolute,     4, false, 3 }, /* 0xAC */
+  { "LDA",  kAbsolute,     4, false, 3 }, /* 0xAD */
+  { "LDX",  kAbsolute,     4, false, 3 }, /* 0xAE */
+  { "LAX",  kAbsolute,     4, false, 3 }, /* 0xAF */
+  /* 0xB0 ~ 0xBF */
+  { "BCS",  kRelative,     2, false, 2 }, /* 0xB0 */
+  { "LDA",  kIndirectY,    5, true,  2 }, /* 0xB1 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0xB2 */
+  { "LAX",  kIndirectY,    5, true,  2 }, /* 0xB3 */
+  { "LDY",  kZeroPageX,    4, false, 2 }, /* 0xB4 */
+  { "LDA",  kZeroPageX,    4, false, 2 }, /* 0xB5 */
+  { "LDX",  kZeroPageY,    4, false, 2 }, /* 0xB6 */
+  { "LAX",  kZeroPageY,    4, false, 2 }, /* 0xB7 */
+  { "CLV",  kImplied,      2, false, 1 }, /* 0xB8 */
+  { "LDA",  kAbsoluteY,    4, true,  3 }, /* 0xB9 */
+  { "TSX",  kImplied,      2, false, 1 }, /* 0xBA */
+  { "LAS",  kAbsoluteY,    4, true,  3 }, /* 0xBB */
+  { "LDY",  kAbsoluteX,    4, true,  3 }, /* 0xBC */
+  { "LDA",  kAbsoluteX,    4, true,  3 }, /* 0xBD */
+  { "LDX",  kAbsoluteY,    4, true,  3 }, /* 0xBE */
+  { "LAX",  kAbsoluteY,    4, true,  3 }, /* 0xBF */
+  /* 0xC0 ~ 0xCF */
+  { "CPY",  kImmediate,    2, false, 2 }, /* 0xC0 */
+  { "CMP",  kIndirectX,    6, false, 2 }, /* 0xC1 */
+  { "NOP",  kImmediate,    2, false, 2 }, /* 0xC2 */
+  { "DCP",  kIndirectX,    8, false, 2 }, /* 0xC3 */
+  { "CPY",  kZeroPage,     3, false, 2 }, /* 0xC4 */
+  { "CMP",  kZeroPage,     3, false, 2 }, /* 0xC5 */
+  { "DEC",  kZeroPage,     5, false, 2 }, /* 0xC6 */
+  { "DCP",  kZeroPage,     5, false, 2 }, /* 0xC7 */
+  { "INY",  kImplied,      2, false, 1 }, /* 0xC8 */
+  { "CMP",  kImmediate,    2, false, 2 }, /* 0xC9 */
+  { "DEX",  kImplied,      2, false, 1 }, /* 0xCA */
+  { "SBX",  kImmediate,    2, false, 2 }, /* 0xCB */
+  { "CPY",  kAbsolute,     4, false, 3 }, /* 0xCC */
+  { "CMP",  kAbsolute,     4, false, 3 }, /* 0xCD */
+  { "DEC",  kAbsolute,     6, false, 3 }, /* 0xCE */
+  { "DCP",  kAbsolute,     6, false, 3 }, /* 0xCF */
+  /* 0xD0 ~ 0xDF */
+  { "BNE",  kRelative,     2, false, 2 }, /* 0xD0 */
+  { "CMP",  kIndirectY,    5, true,  2 }, /* 0xD1 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0xD2 */
+  { "DCP",  kIndirectY,    8, false, 2 }, /* 0xD3 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0xD4 */
+  { "CMP",  kZeroPageX,    4, false, 2 }, /* 0xD5 */
+  { "DEC",  kZeroPageX,    6, false, 2 }, /* 0xD6 */
+  { "DCP",  kZeroPageX,    6, false, 2 }, /* 0xD7 */
+  { "CLD",  kImplied,      2, false, 1 }, /* 0xD8 */
+  { "CMP",  kAbsoluteY,    4, true,  3 }, /* 0xD9 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0xDA */
+  { "DCP",  kAbsoluteY,    7, false, 3 }, /* 0xDB */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0xDC */
+  { "CMP",  kAbsoluteX,    4, true,  3 }, /* 0xDD */
+  { "DEC",  kAbsoluteX,    7, false, 3 }, /* 0xDE */
+  { "DCP",  kAbsoluteX,    7, false, 3 }, /* 0xDF */
+  /* 0xE0 ~ 0xEF */
+  { "CPX",  kImmediate,    2, false, 2 }, /* 0xE0 */
+  { "SBC",  kIndirectX,    6, false, 2 }, /* 0xE1 */
+  { "NOP",  kImmediate,    2, false, 2 }, /* 0xE2 */
+  { "ISC",  kIndirectX,    8, false, 2 }, /* 0xE3 */
+  { "CPX",  kZeroPage,     3, false, 2 }, /* 0xE4 */
+  { "SBC",  kZeroPage,     3, false, 2 }, /* 0xE5 */
+  { "INC",  kZeroPage,     5, false, 2 }, /* 0xE6 */
+  { "ISC",  kZeroPage,     5, false, 2 }, /* 0xE7 */
+  { "INX",  kImplied,      2, false, 1 }, /* 0xE8 */
+  { "SBC",  kImmediate,    2, false, 2 }, /* 0xE9 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0xEA */
+  { "USBC", kImmediate,    2, false, 2 }, /* 0xEB */
+  { "CPX",  kAbsolute,     4, false, 3 }, /* 0xEC */
+  { "SBC",  kAbsolute,     4, false, 3 }, /* 0xED */
+  { "INC",  kAbsolute,     6, false, 3 }, /* 0xEE */
+  { "ISC",  kAbsolute,     6, false, 3 }, /* 0xEF */
+  /* 0xF0 ~ 0xFF */
+  { "BEQ",  kRelative,     2, false, 2 }, /* 0xF0 */
+  { "SBC",  kIndirectY,    5, true,  2 }, /* 0xF1 */
+  { "JAM",  kImplied,      1, false, 1 }, /* 0xF2 */
+  { "ISC",  kIndirectY,    8, false, 2 }, /* 0xF3 */
+  { "NOP",  kZeroPageX,    4, false, 2 }, /* 0xF4 */
+  { "SBC",  kZeroPageX,    4, false, 2 }, /* 0xF5 */
+  { "INC",  kZeroPageX,    6, false, 2 }, /* 0xF6 */
+  { "ISC",  kZeroPageX,    6, false, 2 }, /* 0xF7 */
+  { "SED",  kImplied,      2, false, 1 }, /* 0xF8 */
+  { "SBC",  kAbsoluteY,    4, true,  3 }, /* 0xF9 */
+  { "NOP",  kImplied,      2, false, 1 }, /* 0xFA */
+  { "ISC",  kAbsoluteY,    7, false, 3 }, /* 0xFB */
+  { "NOP",  kAbsoluteX,    4, true,  3 }, /* 0xFC */
+  { "SBC",  kAbsoluteX,    4, true,  3 }, /* 0xFD */
+  { "INC",  kAbsoluteX,    7, false, 3 }, /* 0xFE */
+  { "ISC",  kAbsoluteX,    7, false, 3 }, /* 0xFF */
+};
+
+
+#endif /* _MOS6510_OPCODES_H */
@@ -80,7 +80,11 @@ void __us_not_in_flash_func(glue_c64) mos6526::glue_c64(mos6510 * _cpu)
 {
   cpu = _cpu;
 
-  cia_cpu_clock = prev_cia_cpu_clock = cpu->cycles();
+  cia_cpu_clock = timer_a_clk = timer_b_clk = cpu->cycles();
+  tod_clock = (cia_cpu_clock + tod_cycles);
+
+  alarm_ = cpu->alarms.add((is_cia2 ? "CIA2" : "CIA1"), alarm_handler, this);
+  schedule();
 
   return;
 }
@@ -101,8 +105,8 @@ void mos6526::set_cycle_fn(ReadCycles c)
 void __us_not_in_flash_func(reset) mos6526::reset()
 {
   /* Base */
-  cia_cpu_clock = prev_cia_cpu_clock = 0;
-  prev_timer_a_counter = prev_timer_b_counter = 0;
+  cia_cpu_clock = timer_a_clk = timer_b_clk = (cpu ? cpu->cycles() : 0);
+  tod_clock = (cia_cpu_clock + tod_cycles);
 
   /* TOD to zero */
   tod_counter = 0x00000000;
@@ -138,7 +142,6 @@ void __us_not_in_flash_func(reset) mos6526::reset()
   timer_a_output_mode = timer_b_output_mode = pPulse;
   /* Set force load and underflow disabled */
   timer_a_force_load = timer_b_force_load = false;
-  timer_a_underflow = timer_b_underflow = false;
   /* Set CRA Serialport mode */
   timer_a_sp_mode = pInput;
   /* Set CRA TOD Hertz */
@@ -154,10 +157,13 @@ void __us_not_in_flash_func(reset) mos6526::reset()
   _ddra = _ddrb = 0xff;
   /* CIA 2 */
   vic_base_addr = 0x0000;
+
+  schedule();
 }
 
 /**
  * @brief Cia1/Cia2 register read acccess
+ * The CIA must be synced to the accessing cycle first
  *
  * @param reg
  * @return uint8_t
@@ -202,7 +208,7 @@ uint8_t __us_not_in_flash_func(read_register) mos6526::read_register(uint8_t reg
       break;
     /* timer a high byte (0x5) */
     case TAH:
-      data = (uint8_t)(timer_a_counter & 0xff00) >> 8;
+      data = (uint8_t)((timer_a_counter & 0xff00) >> 8);
       break;
     /* timer b low byte (0x6) */
     case TBL:
@@ -210,7 +216,7 @@ uint8_t __us_not_in_flash_func(read_register) mos6526::read_register(uint8_t reg
       break;
     /* timer b high byte (0x7) */
     case TBH:
-      data = (uint8_t)(timer_b_counter & 0xff00) >> 8;
+      data = (uint8_t)((timer_b_counter & 0xff00) >> 8);
       break;
     /* RTC 1/10s (0x8) */
     case TODTEN:
@@ -323,6 +329,7 @@ uint8_t __us_not_in_flash_func(read_register) mos6526::read_register(uint8_t reg
 
 /**
  * @brief Cia1/Cia2 register write acccess
+ * The CIA must be synced to the accessing cycle first
  *
  * @param reg
  * @param value
@@ -461,11 +468,6 @@ void __us_not_in_flash_func(write_register) mos6526::write_register(uint8_t reg,
       break;
     /* control timer a (0xE) */
     case CRA:
-      /* 0b00010000 */
-      if (!(value & FORCELOAD_STROBE) /* forceload is 0 in value */
-        && timer_a_force_load) { /* but already set */
-        value |= FORCELOAD_STROBE; /* set in value */
-      }
       /* 0b00000001 */
       if (ISSET_BIT(value,ENABLE_TIMER)) timer_a_enabled = pStartTimer; else timer_a_enabled = pStopTimer;
       /* 0b00000010 */
@@ -494,14 +496,13 @@ void __us_not_in_flash_func(write_register) mos6526::write_register(uint8_t reg,
         timer_a_output_mode,
         timer_a_portb_out,
         timer_a_enabled);
+      if (timer_a_force_load) { /* Strobe loads the latch right away */
+        timer_a_counter = timer_a_prescaler;
+        timer_a_force_load = false;
+      }
       break;
     /* control timer b (0xF) */
     case CRB:
-      /* 0b00010000 */
-      if (!(value & FORCELOAD_STROBE) /* forceload is 0 in value */
-        && timer_b_force_load) { /* but already set */
-        value |= FORCELOAD_STROBE; /* set in value */
-      }
       /* 0b00000001 */
       if (ISSET_BIT(value,ENABLE_TIMER)) timer_b_enabled = pStartTimer; else timer_b_enabled = pStopTimer;
       /* 0b00000010 */
@@ -536,9 +537,15 @@ void __us_not_in_flash_func(write_register) mos6526::write_register(uint8_t reg,
         timer_b_output_mode,
         timer_b_portb_out,
         timer_b_enabled);
+      if (timer_b_force_load) { /* Strobe loads the latch right away */
+        timer_b_counter = timer_b_prescaler;
+        timer_b_force_load = false;
+      }
       break;
   }
 
+  /* Timers or TOD may have been (re)started, stopped or reloaded */
+  schedule();
 }
 
 /**
@@ -584,139 +591,171 @@ uint_least16_t __us_not_in_flash_func(vic_base_address) mos6526::vic_base_addres
 }
 
 /**
- * @brief Cia1/Cia2 Timer A emulation
+ * @brief Timer A counts system clock (or CNT) cycles
+ *
+ */
+bool __us_not_in_flash_func(timer_a_counts) mos6526::timer_a_counts(void)
+{
+  /* CNT is used by So-Phisticated_III_loader.sid, counted as PHI2 */
+  return (timer_a_enabled
+    && ((timer_a_input_mode == pModePHI2) || (timer_a_input_mode == pModeCNT)));
+}
+
+/**
+ * @brief Timer B counts system clock (or CNT) cycles
  *
  */
-void __us_not_in_flash_func(timer_a) mos6526::timer_a(void)
+bool __us_not_in_flash_func(timer_b_counts) mos6526::timer_b_counts(void)
+{
+  return (timer_b_enabled
+    && ((timer_b_input_mode == pModePHI2) || (timer_b_input_mode == pModeCNT)));
+}
+
+/**
+ * @brief Timer B counts timer A underflows
+ * Used by Graphixmania_2_part_6.sid / Demi-Demo_4.sid
+ */
+bool __us_not_in_flash_func(timer_b_counts_a) mos6526::timer_b_counts_a(void)
 {
-  /* Check for force load latch requested */
-  if _MOS_UNLIKELY (timer_a_force_load) {
-    timer_a_counter = timer_a_prescaler; /* reload timer */
+  return (timer_b_enabled
+    && ((timer_b_input_mode == pModeTimerA) || (timer_b_input_mode == pModeTimerACNT)));
+}
+
+/**
+ * @brief Timer A underflows change more than its counter, they
+ * raise an interrupt, stop the timer or clock timer B
+ *
+ */
+bool __us_not_in_flash_func(timer_a_observed) mos6526::timer_a_observed(void)
+{
+  return (timer_a_irq_enabled || (timer_a_run_mode == pModeOneShot) || timer_b_counts_a());
+}
+
+bool __us_not_in_flash_func(timer_b_observed) mos6526::timer_b_observed(void)
+{
+  return (timer_b_irq_enabled || (timer_b_run_mode == pModeOneShot));
+}
+
+/**
+ * @brief Cycle of the next timer A underflow, the counter
+ * underflows when it would count below zero
+ *
+ */
+CPUCLOCK __us_not_in_flash_func(timer_a_next_underflow) mos6526::timer_a_next_underflow(void)
+{
+  if (!timer_a_counts()) return RUN_FOREVER;
+  return (timer_a_clk + timer_a_counter + 1);
+}
+
+/**
+ * @brief Cycle of the next timer B underflow when counting clock
+ * cycles, cascaded underflows happen on timer A underflows
+ *
+ */
+CPUCLOCK __us_not_in_flash_func(timer_b_next_underflow) mos6526::timer_b_next_underflow(void)
+{
+  if (!timer_b_counts()) return RUN_FOREVER;
+  return (timer_b_clk + timer_b_counter + 1);
+}
+
+/**
+ * @brief Trigger an IRQ on Cia1 or an NMI on Cia2
+ *
+ */
+void __us_not_in_flash_func(interrupt) mos6526::interrupt(void)
+{
+  if(is_cia2) {
+    cpu->nmi(is_cia2); /* Trigger interrupt */
+  } else {
+    cpu->irq(is_cia2); /* Trigger interrupt */
   }
-  /* Check for timer A enabled*/
-  if _MOS_LIKELY (timer_a_enabled) {
-
-    /* Check for count Phi2 enabled */
-    if ((timer_a_input_mode == pModePHI2)
-        /* Checp for CNT enabled */
-        || (timer_a_input_mode == pModeCNT)) { /* Used by So-Phisticated_III_loader.sid */
-
-      timer_a_counter -= (cia_cpu_clock - prev_cia_cpu_clock); /* Update counter */
-      /* Check for counter underflow */
-      if _MOS_UNLIKELY (timer_a_counter >= 0xffff) {
-        timer_a_underflow = true;
-        timer_a_counter = timer_a_prescaler; /* reload timer */
-
-        // if (timer_a_portb_out) {
-        //   if (_prb & 0x40) {
-        //     _prb &= ~(1<<6); /* Unset PB7 in portB */
-        //   } else {
-        //     _prb |= (1<<6); /* Set PB7 in portB */
-        //   }
-        // }
-
-        /* Generate interrupt if write mask allows */
-        if (timer_a_irq_enabled) {
-          timer_a_irq_triggered = irq_triggered = true; /* Set interrupt bits in read ICR */
-
-          if(is_cia2) {
-            cpu->nmi(is_cia2); /* Trigger interrupt */
-          } else {
-            cpu->irq(is_cia2); /* Trigger interrupt */
-          }
+}
 
-        }
-        /* If one-shot is enabled */
-        if (timer_a_run_mode == pModeOneShot) {
-          timer_a_enabled = pStopTimer; /* Disable timer A in write register*/
-        }
+/**
+ * @brief Cia1/Cia2 Timer A underflow at cycle clk
+ *
+ */
+void __us_not_in_flash_func(timer_a_underflow_at) mos6526::timer_a_underflow_at(CPUCLOCK clk)
+{
+  timer_a_counter = timer_a_prescaler; /* reload timer */
+  timer_a_clk = clk;
 
-      }
+  /* Generate interrupt if write mask allows */
+  if (timer_a_irq_enabled) {
+    timer_a_irq_triggered = irq_triggered = true; /* Set interrupt bits in read ICR */
+    interrupt();
+  }
+  /* If one-shot is enabled */
+  if (timer_a_run_mode == pModeOneShot) {
+    timer_a_enabled = pStopTimer; /* Disable timer A in write register*/
+  }
+  /* Cascaded timer B counts one down */
+  if (timer_b_counts_a()) {
+    if (timer_b_counter == 0) {
+      timer_b_underflow_at(clk);
+    } else {
+      timer_b_counter--;
     }
   }
-  timer_a_force_load = false;   /* Reset timer A strobe bit */
-  timer_a_underflow = false; /* Reset underflow */
 }
 
 /**
- * @brief Cia1/Cia2 Timer B emulation
+ * @brief Cia1/Cia2 Timer B underflow at cycle clk
  *
  */
-void __us_not_in_flash_func(timer_b) mos6526::timer_b(void)
+void __us_not_in_flash_func(timer_b_underflow_at) mos6526::timer_b_underflow_at(CPUCLOCK clk)
 {
-  /* Check for force load latch requested */
-  if _MOS_UNLIKELY (timer_b_force_load) {
-    timer_b_counter = timer_b_prescaler; /* reload timer */
+  timer_b_counter = timer_b_prescaler; /* reload timer */
+  timer_b_clk = clk;
+
+  /* Generate interrupt if write mask allows */
+  if (timer_b_irq_enabled) {
+    timer_b_irq_triggered = irq_triggered = true; /* Set interrupt bits in read ICR */
+    interrupt();
   }
-  /* Check for timer B enabled */
-  if _MOS_LIKELY (timer_b_enabled) {
-    /* Check for count Phi2 enabled */
-    if _MOS_LIKELY ((timer_b_input_mode == pModePHI2)
-                    || (timer_b_input_mode == pModeCNT)) {
-
-      timer_b_counter -= (cia_cpu_clock - prev_cia_cpu_clock); /* Update counter */
-      /* Check for counter underflow */
-      if _MOS_UNLIKELY (timer_b_counter >= 0xffff) {
-        timer_b_underflow = true;
-        timer_b_counter = timer_b_prescaler; /* reload timer */
-
-        // if (timer_b_portb_out) {
-        //   if (_prb & 0x40) {
-        //     _prb &= ~(1<<6); /* Unset PB7 in portB */
-        //   } else {
-        //     _prb |= (1<<6); /* Set PB7 in portB */
-        //   }
-        // }
-
-        /* Generate interrupt if write mask allows */
-        if (timer_b_irq_enabled) {
-          timer_b_irq_triggered = irq_triggered = true; /* Set interrupt bits in read ICR */
-          if(is_cia2) {
-            cpu->nmi(is_cia2); /* Trigger interrupt */
-          } else {
-            cpu->irq(is_cia2); /* Trigger interrupt */
-          }
-        }
+  /* If one-shot is enabled */
+  if (timer_b_run_mode == pModeOneShot) {
+    timer_b_enabled = pStopTimer; /* Disable timer B in write register*/
+  }
+}
 
-        if (timer_b_run_mode == pModeOneShot) { /* If one-shot is enabled */
-          timer_b_enabled = pStopTimer; /* Disable timer B in write register*/
-        }
+/**
+ * @brief Bring both timers to cycle now
+ *
+ * Counters are stored with the cycle they were valid at and only
+ * computed here. Underflows up to now are replayed in order at
+ * their exact cycle, whole periods of underflows nobody observes
+ * are skipped in one go. Called by the mmu before every register
+ * access and by the CIA alarm.
+ *
+ * @param now
+ */
+void __us_not_in_flash_func(sync) mos6526::sync(CPUCLOCK now)
+{
+  for (;;) {
+    CPUCLOCK a = timer_a_next_underflow();
+    CPUCLOCK b = timer_b_next_underflow();
+    if _MOS_LIKELY (a > now && b > now) break;
+    if (a <= b) {
+      if (!timer_a_observed()) {
+        a += (((now - a) / ((CPUCLOCK)timer_a_prescaler + 1)) * ((CPUCLOCK)timer_a_prescaler + 1));
       }
-    }
-    /* Check for count TimerA enabled */
-    if _MOS_UNLIKELY ((timer_b_input_mode == pModeTimerA) /* Used by Graphixmania_2_part_6.sid / Demi-Demo_4.sid */
-                      || (timer_b_input_mode == pModeTimerACNT)) {
-
-      timer_b_counter = timer_a_counter; /* Update counter */
-
-      /* Check for counter underflow */
-      if (timer_a_counter > prev_timer_a_counter) { timer_b_underflow = true; }
-      /* counter underflow */
-      if _MOS_UNLIKELY (timer_b_underflow) {
-        timer_b_counter = timer_a_counter;
-        /* Generate interrupt if write mask allows */
-        if (timer_b_irq_enabled) {
-          timer_b_irq_triggered = irq_triggered = true; /* Set interrupt bit in read ICR */
-          if(is_cia2) {
-            cpu->nmi(is_cia2); /* Trigger interrupt */
-          } else {
-            cpu->irq(is_cia2); /* Trigger interrupt */
-          }
-        }
-        /* If one-shot is enabled */
-        if (timer_b_run_mode == pModeOneShot) {
-          timer_b_enabled = pStopTimer; /* Disable timer B in write register*/
-        }
+      timer_a_underflow_at(a);
+    } else {
+      if (!timer_b_observed()) {
+        b += (((now - b) / ((CPUCLOCK)timer_b_prescaler + 1)) * ((CPUCLOCK)timer_b_prescaler + 1));
       }
-      prev_timer_a_counter = timer_a_counter;
+      timer_b_underflow_at(b);
     }
   }
-  timer_b_force_load = false; /* Reset timer B strobe bit */
-  timer_b_underflow = false; /* Reset underflow */
+  if (timer_a_counts()) timer_a_counter -= (TIMER)(now - timer_a_clk);
+  if (timer_b_counts()) timer_b_counter -= (TIMER)(now - timer_b_clk);
+  timer_a_clk = timer_b_clk = cia_cpu_clock = now;
+  return;
 }
 
 /**
- * @brief Fake time of day timer
+ * @brief Fake time of day timer, ticks every tod_cycles
  * test sidtunes
  * /MUSICIANS/K/Kawasaki_Ryo/Kawasaki_Synthesizer_Demo.sid
  * /MUSICIANS/M/Merman/Traffic.sid
@@ -763,25 +802,58 @@ void __us_not_in_flash_func(tod) mos6526::tod(void)
 }
 
 /**
- * @brief: emulate a single CIA timer run
- * NOTE: not single cycle exact
+ * @brief: catch the CIA up with the cpu
+ *
  */
 bool __us_not_in_flash_func(emulate) mos6526::emulate(void)
 {
-  // if _MOS_UNLIKELY (!check_cyclefn()) {
-  //   D("[CIA] ERROR! Cannot emulate without CPU cycles!\n");
-  //   return false;
-  // }
+  sync(cpu->cycles());
+  return true;
+}
 
-  cia_cpu_clock = cpu->cycles();
+/**
+ * @brief Returns the cpu cycle of the next underflow that raises
+ * an interrupt, stops a one-shot timer or clocks a cascaded timer
+ * B, or of the next time of day tick
+ *
+ * Other underflows only reload the counter and are left to sync()
+ */
+CPUCLOCK __us_not_in_flash_func(next_event) mos6526::next_event(void)
+{
+  CPUCLOCK next = tod_clock;
+  if (timer_a_observed()) next = MIN(next, timer_a_next_underflow());
+  if (timer_b_observed()) next = MIN(next, timer_b_next_underflow());
+  return next;
+}
 
-  timer_a();
-  timer_b();
+/**
+ * @brief Set the CIA alarm to its next event
+ *
+ */
+void __us_not_in_flash_func(schedule) mos6526::schedule(void)
+{
+  if _MOS_UNLIKELY (alarm_ < 0) return; /* Not glued yet */
+  cpu->alarms.set(alarm_, next_event());
+  return;
+}
 
-  tod();
+/**
+ * @brief CIA alarm callback, runs the timers and the time of day
+ * clock up to the current cycle
+ *
+ */
+void __us_not_in_flash_func(alarm_handler) mos6526::alarm_handler(void *context, CPUCLOCK clk)
+{
+  mos6526 *cia = (mos6526 *)context;
+  (void)clk;
 
-  prev_cia_cpu_clock = cia_cpu_clock;
-  return true;
+  cia->sync(cia->cpu->cycles());
+  if (cia->cia_cpu_clock >= cia->tod_clock) {
+    cia->tod();
+    cia->tod_clock += cia->tod_cycles;
+  }
+  cia->schedule();
+  return;
 }
 
 /**
@@ -34,6 +34,7 @@
 
 #include <cstdint>
 #include <types.h>
+#include <scheduler.h>
 
 
 class mos6510;
@@ -44,7 +45,8 @@ class mos6526
 {
   private:
     /* Glue */
-    mos6510 * cpu;
+    mos6510 * cpu = nullptr;
+    alarm_t alarm_ = -1;
     /* Init */
     uint_least16_t cia_address;
 
@@ -53,8 +55,8 @@ class mos6526
     uint_least8_t r_shadow[0x10];
 
     /* Variables */
-    CPUCLOCK cia_cpu_clock;
-    CPUCLOCK prev_cia_cpu_clock;
+    CPUCLOCK cia_cpu_clock; /* Last sync */
+    CPUCLOCK tod_clock; /* Next time of day tick */
     bool log_rw = false;
 
     /* Private constants */
@@ -166,8 +168,8 @@ class mos6526
     /* TIMER(uint32_t) to account for 16bit underflow */
     TIMER timer_a_counter;   /* 0x04,0x05 read ~ counter */
     TIMER timer_b_counter;   /* 0x06,0x07 read ~ counter */
-    TIMER prev_timer_a_counter;
-    TIMER prev_timer_b_counter;
+    CPUCLOCK timer_a_clk;    /* Cycle at which timer_a_counter holds */
+    CPUCLOCK timer_b_clk;    /* Cycle at which timer_b_counter holds */
     uint16_t timer_a_prescaler; /* 0x04,0x05 write ~ latch */
     uint16_t timer_b_prescaler; /* 0x06,0x07 write ~ latch */
 
@@ -189,7 +191,6 @@ class mos6526
     bool timer_a_input_mode;    /* _cra & 0b00100000 ~ pInputMode */
     bool timer_a_sp_mode;       /* _cra & 0b01000000 */
     bool timer_a_is_50hz;       /* _cra & 0b10000000 */
-    bool timer_a_underflow;
 
     bool timer_b_irq_enabled;   /* _imr & 0b00000010 ~ pIRQMode */
     bool timer_b_irq_triggered; /* _icr & 0b00000010 ~ pIRQMode */
@@ -200,7 +201,6 @@ class mos6526
     bool timer_b_force_load;    /* _crb & 0b00010000 */
     uint8_t timer_b_input_mode; /* _crb & 0b01100000 ~ pInputMode (4 modes, so not boolean) */
     bool timer_b_wrtod_mode;    /* _crb & 0b10000000 */
-    bool timer_b_underflow;
 
     bool tod_running; /* Time of day */
     bool tod_latched; /* Time of day latch */
@@ -215,6 +215,21 @@ class mos6526
     inline bool _is_cia2(void) { return (cia_address == 0xDD00); };
     bool is_cia2;
 
+    static void alarm_handler(void *context, CPUCLOCK clk);
+    void schedule(void);
+
+    /* Lazy timers */
+    bool timer_a_counts(void);
+    bool timer_b_counts(void);
+    bool timer_b_counts_a(void);
+    bool timer_a_observed(void);
+    bool timer_b_observed(void);
+    CPUCLOCK timer_a_next_underflow(void);
+    CPUCLOCK timer_b_next_underflow(void);
+    void timer_a_underflow_at(CPUCLOCK clk);
+    void timer_b_underflow_at(CPUCLOCK clk);
+    void interrupt(void);
+
   public:
     mos6526(uint_least16_t base_address);
     ~mos6526(void);
@@ -234,10 +249,13 @@ class mos6526
     uint16_t ta_prescaler(void) { return timer_a_prescaler; };
     uint_least16_t vic_base_address(void);
 
-    void timer_a(void);
-    void timer_b(void);
     void tod(void);
+    void sync(CPUCLOCK now);
     bool emulate(void);
+    CPUCLOCK next_event(void);
+
+    /* Cycles per time of day tick (1/10s), PAL by default */
+    CPUCLOCK tod_cycles = 98525;
 
     void dump_prab(void);
     void dump_irqs(void);
@@ -76,6 +76,10 @@ void __us_not_in_flash_func(glue_c64) mos6560_6561::glue_c64(VicReadDMA rdma, mo
   cpu = _cpu;
   sid = _sid;
   vic_dma_read = (VicReadDMA)rdma;
+
+  vic_cpu_clock = frame_clk = cpu->cycles();
+  alarm_ = cpu->alarms.add("VIC", alarm_handler, this);
+  schedule();
 }
 
 /**
@@ -84,9 +88,10 @@ void __us_not_in_flash_func(glue_c64) mos6560_6561::glue_c64(VicReadDMA rdma, mo
  */
 void __us_not_in_flash_func(reset) mos6560_6561::reset(void)
 {
-  vic_cpu_clock = 0;
-  prev_vic_cpu_clock = 0;
+  vic_cpu_clock = frame_clk = (cpu ? cpu->cycles() : 0);
+  event_clk = RUN_FOREVER;
   start_sync_tick = 0;
+  sync_emulated_ticks_offset = 0.0;
   start_sync_clk = 0;
 
   graphic_mode_ = pCharMode;
@@ -102,7 +107,6 @@ void __us_not_in_flash_func(reset) mos6560_6561::reset(void)
   control_register_one = 0;
   control_register_one_read = 0;
   control_register_two = 0;
-  raster_row_lines = 0;
   sprite_enabled = 0;
   irq_status = 0;
   irq_enabled = 0;
@@ -110,14 +114,15 @@ void __us_not_in_flash_func(reset) mos6560_6561::reset(void)
 
   memory_ptrs = 0b1u; /* Bit 0 is not used and always set to 1 */
 
-  row_cycle_count = 0;
   raster_irq = 0;
 
+  schedule();
   return;
 }
 
 /**
  * @brief VIC-II register write access
+ * The VIC must be synced to the accessing cycle first
  *
  * @param reg
  * @return reg_t
@@ -132,10 +137,10 @@ reg_t __us_not_in_flash_func(read_register) mos6560_6561::read_register(reg_t re
       data = r_sprite_msbs;
       return data;
     case CONTROLA: /* 0x11 */
-      data = control_register_one;
+      data = (control_register_one | ((raster_row(vic_cpu_clock) & 0x100u) >> 1u));
       return data;
     case RASTERROWL: /* 0x12 */
-      data = raster_row_lines;
+      data = (raster_row(vic_cpu_clock) & 0xffu);
       return data;
     case LIGHTPEN_X_COORD: /* 0x13 */
       data = r_lightpen_x;
@@ -194,23 +199,25 @@ reg_t __us_not_in_flash_func(read_register) mos6560_6561::read_register(reg_t re
 
 /**
  * @brief VIC-II register read access
+ * The VIC must be synced to the accessing cycle first
  *
  * @param reg
  * @param value
  */
 void __us_not_in_flash_func(write_register) mos6560_6561::write_register(reg_t reg, val_t value)
 {
-
   switch (reg) {
     case SPR_X_COORD_MSB: /* 0x10 */
       r_sprite_msbs = value;
       return;
     case CONTROLA: /* 0x11 */
       control_register_one = (value&0x7fu);
-      raster_irq = ((value&RASTERROWMSB) << 1u);
+      raster_irq = (((value&RASTERROWMSB) << 1u) | (raster_irq & 0xffu));
+      schedule(); /* Stun rows and raster irq row changed */
       return;
     case RASTERROWL: /* 0x12 */
       raster_irq = value | (raster_irq & 0x100u);
+      schedule();
       return;
     case LIGHTPEN_X_COORD: /* 0x13 */
       r_lightpen_x = value;
@@ -232,6 +239,7 @@ void __us_not_in_flash_func(write_register) mos6560_6561::write_register(reg_t r
       return;
     case INTERRUPT_ENABLE: /* 0x1A */
       irq_enabled = (value&0xfu);
+      schedule();
       return;
     case BORDER_COLOR: /* 0x20 */
       r_border_color = value;
@@ -269,99 +277,131 @@ void __us_not_in_flash_func(write_register) mos6560_6561::write_register(reg_t r
 }
 
 /**
- * @brief: emulate a single VIC-II raster cycle run
+ * @brief: catch the VIC-II up with the cpu
  * NOTE: not single cycle exact
  *
  */
 void __us_not_in_flash_func(emulate) mos6560_6561::emulate(void)
 {
-  vic_cpu_clock = cpu->cycles();
-  static tick_t cycles;
-
-  cycles = (vic_cpu_clock - prev_vic_cpu_clock);
-  static tick_t vic_cycles;
-  vic_cycles+=cycles;
-
-  row_cycle_count += cycles;
-
-  // if _MOS_UNLIKELY ((row_cycle_count >= 55) && (row_cycle_count <= 62)) {
-  //   int sprite_id = (row_cycle_count - 55)/*  / 2 */;
-
-  //   /* Check if sprite is enabled ($D015) */
-  //   if _MOS_UNLIKELY (sprite_enabled & (1 << sprite_id)) {
-  //       cpu->tickle_me(1); /* Stall CPU by simulating to pull the Bus Available line low */
-  //       // cpu->stall_cpu(true); /* Stall CPU by simulating to pull the Bus Available line low */
-  //       // MOSDBG("[VIC] row_cycle_count: %u sprite_id: %d\n",row_cycle_count,sprite_id);
-  //       /* Perform DMA Reads */
-  //       /* Fetch Pointer from end of current Screen Matrix ($07F8-$07FF) */
-  //       // uint16_t ptr_addr = 0x07F8 + sprite_id;
-  //       // uint8_t pointer = s->ram[ptr_addr];
-  //       // uint8_t sprite_pointer = vic_dma_read(ptr_addr);
-
-  //       // Fetch 3 bytes of sprite data for this line
-  //       // uint16_t data_addr = pointer * 64 + (s->raster_line % 21) * 3;
-
-  //       // In a real emulator, these reads happen across specific phases
-  //       // s->sprite_buffers[sprite_id][0] = s->ram[data_addr];
-  //   } else {
-  //       cpu->stall_cpu(false);
-  //   }
-  // } else {
-  //   cpu->stall_cpu(false);
-  // }
-
-  if _MOS_UNLIKELY (row_cycle_count >= raster_row_cycles) {
-    row_cycle_count -= raster_row_cycles;
-
-    if (stun()) {
-      cpu->cycles(cpu->cycles()+23);
-    }
+  sync(cpu->cycles());
+  return;
+}
+
+/**
+ * @brief Bring the VIC-II to cycle now
+ *
+ * Runs the raster events up to now, called by the mmu before every
+ * register access and by the VIC alarm. Lines without events are
+ * never visited, the raster position is computed from the cycle on
+ * demand.
+ *
+ * @param now
+ */
+void __us_not_in_flash_func(sync) mos6560_6561::sync(CPUCLOCK now)
+{
+  while _MOS_UNLIKELY (event_clk <= now) {
+    raster_event(event_clk);
+    event_clk = next_event();
+  }
 
-    uint_fast16_t current_raster_row_ = raster_row();
+  vic_cpu_clock = now;
+  return;
+}
 
-    if _MOS_UNLIKELY ((irq_enabled & RASTERROW_MATCH_IRQ) &&
-      (current_raster_row_ == raster_irq)) {
-      irq_status |= (VIC_IRQ | RASTERROW_MATCH_IRQ);
-      cpu->irq(2);
-    }
+/**
+ * @brief Handle the line start at cycle clk
+ *
+ * The cpu is stunned at the end of a bad line, the raster irq
+ * fires at the start of the compare line
+ */
+void __us_not_in_flash_func(raster_event) mos6560_6561::raster_event(CPUCLOCK clk)
+{
+  uint_fast16_t line = (uint_fast16_t)((clk - frame_clk) / raster_row_cycles);
+  vic_cpu_clock = clk;
 
-    ++current_raster_row_;
+  if (stun(line - 1)) {
+    cpu->cycles(cpu->cycles()+23);
+  }
 
-    if _MOS_UNLIKELY (current_raster_row_ >= raster_lines) {
-      current_raster_row_ = 0;
-      vic_cycles = 0;
-      sid->sid_flush();
-      vsync_do_end_of_line();
-    }
+  if _MOS_UNLIKELY (line >= raster_lines) {
+    frame_clk = clk;
+    line = 0;
+    sid->sid_flush();
+    if (realtime) vsync_do_end_of_line();
+  }
 
-    control_register_one = ((control_register_one & ~RASTERROWMSB) | ((current_raster_row_ & 0x100) >> 1));
-    raster_row_lines = (current_raster_row_ & 0xFF);
+  if _MOS_UNLIKELY ((irq_enabled & RASTERROW_MATCH_IRQ) && (line == raster_irq)) {
+    irq_status |= (VIC_IRQ | RASTERROW_MATCH_IRQ);
+    cpu->irq(2);
   }
+  return;
+}
+
+/**
+ * @brief Returns the cpu cycle at which the next raster line starts
+ * that raises an interrupt, follows a stunned line or starts a
+ * new frame
+ *
+ * @return CPUCLOCK
+ */
+CPUCLOCK __us_not_in_flash_func(next_event) mos6560_6561::next_event(void)
+{
+  /* First line start after the last sync */
+  uint_fast16_t line = (uint_fast16_t)((vic_cpu_clock - frame_clk) / raster_row_cycles + 1);
+  /* Line starts without anything happening can be passed */
+  for (; line < raster_lines; line++) {
+    if (stun(line - 1)) break;
+    if ((irq_enabled & RASTERROW_MATCH_IRQ) && (line == raster_irq)) break;
+  }
+  return (frame_clk + ((CPUCLOCK)line * raster_row_cycles));
+}
+
+/**
+ * @brief Set the VIC alarm to the next raster line that does
+ * something, lines in between are caught up on register access
+ *
+ */
+void __us_not_in_flash_func(schedule) mos6560_6561::schedule(void)
+{
+  if _MOS_UNLIKELY (alarm_ < 0) return; /* Not glued yet */
+  event_clk = next_event();
+  cpu->alarms.set(alarm_, event_clk);
+  return;
+}
 
-  prev_vic_cpu_clock = vic_cpu_clock;
+/**
+ * @brief VIC alarm callback
+ *
+ */
+void __us_not_in_flash_func(alarm_handler) mos6560_6561::alarm_handler(void *context, CPUCLOCK clk)
+{
+  mos6560_6561 *vic = (mos6560_6561 *)context;
+  (void)clk;
+
+  vic->emulate();
+  vic->cpu->alarms.set(vic->alarm_, vic->event_clk);
   return;
 }
 
 /**
- * @brief Return the current raster row based on registers
- * raster_row_lines and control_register_one
+ * @brief Return the raster row at cycle clk
  *
  * @return uint_fast16_t
  */
-uint_fast16_t __us_not_in_flash_func(raster_row) mos6560_6561::raster_row(void)
+uint_fast16_t __us_not_in_flash_func(raster_row) mos6560_6561::raster_row(CPUCLOCK clk)
 {
-  return (((control_register_one & RASTERROWMSB) << 1u) + raster_row_lines);
+  return (uint_fast16_t)(((clk - frame_clk) / raster_row_cycles) % raster_lines);
 }
 
 /**
- * @brief Returns true if we need to stun the cpu right now
+ * @brief Returns true if we need to stun the cpu at the end of row
  *
+ * @param current_raster_row_
  * @return true
  * @return false
  */
-bool __us_not_in_flash_func(stun) mos6560_6561::stun(void)
+bool __us_not_in_flash_func(stun) mos6560_6561::stun(uint_fast16_t current_raster_row_)
 {
-  uint_fast16_t current_raster_row_ = raster_row();
   bool _stun = (
     (current_raster_row_ >= 0x30) /* 48 */
     && (current_raster_row_ <= 0xf7 /* 247 */
@@ -436,9 +476,6 @@ void __us_not_in_flash_func(vsync_do_end_of_line) mos6560_6561::vsync_do_end_of_
   CPUCLOCK sync_clk_delta = 0;
   double sync_emulated_ticks = 0.0;
 
-  /* used to preserve the fractional ticks betwen calls */
-  static double sync_emulated_ticks_offset;
-
   tick_now = tick_now_after(last_sync_tick);
 
   if (sync_reset) {
@@ -600,7 +637,7 @@ void mos6560_6561::dump_irqs(void)
 void mos6560_6561::dump_regs(void)
 {
   MOSDBG("[CRA]%02x[RRL]%02x[SPR]%02x[CRB]%02x[IRQ]%02x[IQE]%02x",
-    control_register_one,raster_row_lines,sprite_enabled,control_register_two,
+    control_register_one,(raster_row(cpu->cycles()) & 0xffu),sprite_enabled,control_register_two,
     irq_status,irq_enabled
   );
 
@@ -614,7 +651,7 @@ void mos6560_6561::dump_regs(void)
 void mos6560_6561::dump_timers(void)
 {
   MOSDBG("[VIC][RR I:%3u/L%3u] ",
-    raster_irq,raster_row_lines
+    raster_irq,raster_row(cpu->cycles())
   );
   return;
 }
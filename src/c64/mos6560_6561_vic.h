@@ -37,6 +37,7 @@
 #include <chrono>
 
 #include <types.h>
+#include <scheduler.h>
 
 
 class mos6510;
@@ -48,11 +49,13 @@ class mos6560_6561
 {
   private:
     /* Glue */
-    mos6510 *cpu;
+    mos6510 *cpu = nullptr;
     mos6581_8580 *sid;
+    alarm_t alarm_ = -1;
 
-    CPUCLOCK vic_cpu_clock;
-    CPUCLOCK prev_vic_cpu_clock;
+    CPUCLOCK vic_cpu_clock; /* Last sync */
+    CPUCLOCK frame_clk;     /* Cycle at which raster line 0 started */
+    CPUCLOCK event_clk;     /* Next line start that does something */
 
     /* Debugging only */
     uint8_t shadow_regs[0x40] = {0};
@@ -110,23 +113,28 @@ class mos6560_6561
     uint_fast8_t control_register_one;
     uint_fast8_t control_register_one_read;
     uint_fast8_t control_register_two;
-    uint_fast8_t raster_row_lines;
     uint_fast8_t sprite_enabled;
     uint_fast8_t irq_status;
     uint_fast8_t irq_enabled;
 
     uint_fast8_t memory_ptrs;
 
-    counter_t row_cycle_count;
     counter_t raster_irq;
 
     typedef val_t (*VicReadDMA)(addr_t);
 
     std::chrono::steady_clock::time_point prev_frame_was_at_;
-    uint_fast16_t raster_row(void);
-    bool stun(void);
+    uint_fast16_t raster_row(CPUCLOCK clk);
+    bool stun(uint_fast16_t row);
+    void raster_event(CPUCLOCK clk);
     void vsync_do_end_of_line(void);
 
+    /* used to preserve the fractional ticks betwen vsync calls */
+    double sync_emulated_ticks_offset;
+
+    static void alarm_handler(void *context, CPUCLOCK clk);
+    void schedule(void);
+
   public:
     mos6560_6561(void);
     ~mos6560_6561(void);
@@ -137,7 +145,9 @@ class mos6560_6561
     reg_t read_register(reg_t reg);
     void write_register(reg_t reg, val_t value);
 
+    void sync(CPUCLOCK now);
     void emulate(void);
+    CPUCLOCK next_event(void);
     int set_timer_speed(int speed);
 
     /* VIC-II DMA read callback function */
@@ -156,6 +166,7 @@ class mos6560_6561
     CPUCLOCK start_sync_clk;
 
     int timer_speed = 0; /* Percentage */
+    bool realtime = true; /* Pace emulation to host time at every frame */
     bool sync_reset = true;
     bool metrics_reset = false;
 
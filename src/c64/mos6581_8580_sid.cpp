@@ -36,18 +36,11 @@
 #include <mmu.h>
 #include <mos6581_8580_sid.h>
 #include <mos6510_cpu.h>
+#include <sidbackend.h>
 
 #include <c64util.h>
 #include <constants.h>
 
-#if DESKTOP
-#include <USBSID.h>
-extern USBSID_NS::USBSID_Class* usbsid;
-#elif EMBEDDED
-extern "C" uint8_t cycled_read_operation(uint8_t address, uint16_t cycles);
-extern "C" void cycled_write_operation(uint8_t address, uint8_t data, uint16_t cycles);
-#endif
-
 
 /**
  * @brief Construct a new mos6581 8580::mos6581 8580 object
@@ -58,6 +51,7 @@ mos6581_8580::mos6581_8580()
   MOSDBG("[SID] Init\n");
 
   srand(time(NULL));
+  map_sids();
   return;
 }
 
@@ -108,90 +102,97 @@ bool __us_not_in_flash_func(custom_sidaddr_check) mos6581_8580::custom_sidaddr_c
   return false;
 }
 
-uint8_t __us_not_in_flash_func(sidaddr_translation) mos6581_8580::sidaddr_translation(uint16_t addr)
+/**
+ * @brief Fill bases with the address of each used SID
+ *
+ * @param bases room for kMaxSids addresses
+ * @return int number of SIDs in use
+ */
+int mos6581_8580::sid_bases(uint16_t *bases)
+{
+  const uint16_t sids[kMaxSids] = {
+    sidone, sidtwo, sidthree, sidfour,
+    sidfive, sidsix, sidseven, sideight
+  };
+  int count = MIN((int)sidcount, kMaxSids);
+  for (int i = 0; i < kMaxSids; i++) {
+    bases[i] = (i < count ? sids[i] : 0x0000);
+  }
+  return count;
+}
+
+/**
+ * @brief Translate a SID address to its physical address
+ *
+ * Only used to build the sidmap table, read_sid and write_sid
+ * look the result up instead of running this per access
+ *
+ * @param addr
+ * @return uint16_t SID number << 8 | physical address,
+ *         SID number 0 when not mapped
+ */
+uint16_t mos6581_8580::sidaddr_translation(uint16_t addr)
 {
   uint8_t sock2add = (forcesockettwo ? (sidssockone == 1 ? 0x20 : sidssockone == 2 ? 0x40 : 0x0) : 0x0);
   if (addr == 0xDF40 || addr == 0xDF50) {
-    if (fmoplsidno >= 1 && fmoplsidno <=4) {
-      sidno = fmoplsidno;
-      return (((sidno - 1) * 0x20) + (addr & 0x1F));
-    } else {
-      sidno = 5; /* Skip */
-      return (0x80 + (addr & 0x1F)); /* Out of scope address */
+    if (fmoplsidno >= 1 && fmoplsidno <= kMaxSids) {
+      return ((fmoplsidno << 8) | (((fmoplsidno - 1) * 0x20) + (addr & 0x1F)));
     }
+    return 0x0000; /* Skip */
   }
-  switch (sidcount) {
-    case 1: /* Easy just return the address */
-      if (addr >= sidone && addr < (sidone + 0x1F)
-         || custom_sidaddr_check(addr)) {
-        sidno = 1;
-        return (sock2add + (addr & 0x1F));
-      };
-      break;
-    case 2: /* Intermediate remap all above 0x20 to sidno 2 */
-      if (addr >= sidone && addr < (sidone + 0x1F)) {
-        sidno = 1;
-        return (addr & 0x1F);
-      } else if (addr >= sidtwo && addr < (sidtwo + 0x1F)) {
-        sidno = 2;
-        return (0x20 + (addr & 0x1F));
-      };
-      break;
-    case 3: /* Advanced */
-      if (addr >= sidone && addr < (sidone + 0x1F)) {
-        sidno = 1;
-        return (addr & 0x1F);
-      } else if (addr >= sidtwo && addr < (sidtwo + 0x1F)) {
-        sidno = 2;
-        return (0x20 + (addr & 0x1F));
-      } else if (addr >= sidthree && addr < (sidthree + 0x1F)) {
-        sidno = 3;
-        return (0x40 + (addr & 0x1F));
-      };
-      break;
-    case 4: /* Expert */
-      if (addr >= sidone && addr < (sidone + 0x1F)) {
-        sidno = 1;
-        return (addr & 0x1F);
-      } else if (addr >= sidtwo && addr < (sidtwo + 0x1F)) {
-        sidno = 2;
-        return (0x20 + (addr & 0x1F));
-      } else if (addr >= sidthree && addr < (sidthree + 0x1F)) {
-        sidno = 3;
-        return (0x40 + (addr & 0x1F));
-      } else if (addr >= sidfour && addr < (sidfour + 0x1F)) {
-        sidno = 4;
-        return (0x60 + (addr & 0x1F));
-      };
-      break;
-    default:
-      break;
-  };
-  return 0xFE;
+  if (sidcount == 1) { /* Easy just return the address */
+    if (addr >= sidone && addr < (sidone + 0x1F)
+       || custom_sidaddr_check(addr)) {
+      return ((1 << 8) | (sock2add + (addr & 0x1F)));
+    }
+    return 0x0000;
+  }
+  /* Remap each SID to its own 0x20 block, first match wins */
+  uint16_t bases[kMaxSids];
+  int count = sid_bases(bases);
+  for (int i = 0; i < count; i++) {
+    if (addr >= bases[i] && addr < (bases[i] + 0x1F)) {
+      return (((i + 1) << 8) | ((i * 0x20) + (addr & 0x1F)));
+    }
+  }
+  return 0x0000;
+}
+
+/**
+ * @brief Build the $d400/$dfff translation table from the current
+ * SID layout, FMOpl mapping and socket forcing, call after changing
+ * any of them
+ *
+ */
+void mos6581_8580::map_sids(void)
+{
+  for (uint16_t i = 0; i < count_of(sidmap); i++) {
+    sidmap[i] = sidaddr_translation(0xD400 + i);
+  }
+  return;
 }
 
 /**
- * @brief Flush USBSID, called at the end of VSYNC
+ * @brief Flush the SID output, called at the end of VSYNC
  *
  * @return * void
  */
 void __us_not_in_flash_func(sid_flush) mos6581_8580::sid_flush(void)
 {
   const CPUCLOCK now = cpu->cycles();
-  CPUCLOCK cycles = (now - sid_main_clk);
-#if DESKTOP
-  usbsid->USBSID_SetFlush(); /* Always flush USB data buffer when called */
-#endif
+  CPUCLOCK cycles = (now < sid_main_clk ? 0 : (now - sid_main_clk));
+  while(cycles > 0xFFFF) {
+    cycles -= 0xFFFF;
+  }
+  /* Always flush the output buffer when called, hardware needs no
+     delay for the remaining cycles but renderers do */
+  if (out) out->flush(cycles);
   if (now < sid_main_clk || w_cyclecount == 0) { /* Reset / flush */
     r_cyclecount = 0;
     w_cyclecount = 0;
     sid_main_clk = now;
     return;
   }
-  while(cycles > 0xFFFF) {
-    cycles -= 0xFFFF;
-  }
-  /* Delay for any remaining cycles is not nescessary anymore */
   sid_main_clk = flush_main_clk = now;
   r_cyclecount = w_cyclecount = 0;
   return;
@@ -208,80 +209,74 @@ unsigned int __us_not_in_flash_func(sid_delay) mos6581_8580::sid_delay(void)
   CPUCLOCK cycles = (now - sid_main_clk);
   while (cycles > 0xFFFF) {
     cycles -= 0xFFFF;
-#if DESKTOP
-    usbsid->USBSID_WaitForCycle(0xFFFF);
-#endif
+    if (out) out->wait(0xFFFF);
   }
   sid_main_clk = now;
   return cycles;
 }
 
 /**
- * @brief Read data from SID address
+ * @brief Read data from SID address, the mmu only routes
+ * $d400/$dfff here
  *
  * @param addr
  * @return uint8_t
  */
+template<class Trace>
 uint8_t __us_not_in_flash_func(read_sid) mos6581_8580::read_sid(uint16_t addr)
 {
   uint8_t data = (rand() % 0xFF) + 1; /* Random value generator */
-  uint8_t phyaddr = (sidaddr_translation(addr) & 0xFF);  /* 4 SIDs max */
+  const uint16_t map = sidmap[(addr - 0xD400)];
+  uint8_t phyaddr = (map & 0xFF);
   uint_fast16_t cycles = sid_delay();
-  if (phyaddr == 0xFE) data = mmu_->dma_read_ram(addr);
-#if EMBEDDED
-  // else cycled_read_operation(phyaddr,cycles);
-  /* No cycles when embedding, not needed */
-  else cycled_read_operation(phyaddr,0);
-#endif
-  if (log_sidrw) {
+  if ((map >> 8) == 0) data = mmu_->dma_read_ram(addr);
+  else if (out) out->read(phyaddr, cycles);
+  if (Trace::enabled && log_sidrw) {
     MOSDBG("[R SID%d] $%04x $%02x:%02x [C]%5u\n",
-      sidno,addr,phyaddr,data,cycles);
+      (map >> 8),addr,phyaddr,data,cycles);
   }
   r_cyclecount += cycles;
   return data;
 }
 
 /**
- * @brief Write data to SID address
+ * @brief Write data to SID address, the mmu only routes
+ * $d400/$dfff here
  *
  * @param addr
  * @param data
  */
+template<class Trace>
 void __us_not_in_flash_func(write_sid) mos6581_8580::write_sid(uint16_t addr, uint8_t data)
 {
-  uint8_t phyaddr = (sidaddr_translation(addr) & 0xFF);  /* 4 SIDs max */
+  const uint16_t map = sidmap[(addr - 0xD400)];
+  uint8_t phyaddr = (map & 0xFF);
   uint_fast16_t cycles = sid_delay();
-#if DESKTOP
-  if (usbsid && (phyaddr != 0xFE)) {
-    /* Delays are essentially not nescessary
-       with current vsync implementation */
-    // usbsid->USBSID_WaitForCycle(cycles);
-    usbsid->USBSID_WriteRingCycled(phyaddr, data, cycles);
+  if (out && ((map >> 8) != 0)) {
+    out->write(phyaddr, data, cycles);
   }
-#elif EMBEDDED
-  if (phyaddr != 0xFE) {
-    // cycled_write_operation(phyaddr, data, cycles);
-    /* No cycles when embedding, not needed */
-    cycled_write_operation(phyaddr, data, 0);
-  }
-#endif
   mmu_->dma_write_ram(addr, data); /* Always write to RAM as mirror */
-  if (log_sidrw) {
+  if (Trace::enabled && log_sidrw) {
     MOSDBG("[W SID%d] $%04x $%02x:%02x [C]%5u\n",
-      sidno,addr,phyaddr,data,cycles);
+      (map >> 8),addr,phyaddr,data,cycles);
   }
   w_cyclecount += cycles;
 
   return;
 }
 
+template uint8_t mos6581_8580::read_sid<trace_off>(uint16_t addr);
+template uint8_t mos6581_8580::read_sid<trace_on>(uint16_t addr);
+template void mos6581_8580::write_sid<trace_off>(uint16_t addr, uint8_t data);
+template void mos6581_8580::write_sid<trace_on>(uint16_t addr, uint8_t data);
+
 /**
  * @brief Prints out the current SID settings
  *
  */
 void mos6581_8580::print_settings(void)
 {
-  MOSDBG("[SID] NUM%d #%d 1$%04x 2$%04x 3$%04x 4$%04x FM%d SOCK1:%d SOCK2:%d s1s1:%d s1s2:%d s2s1:%d s2s2:%d FSOCK2:%d\n",
+  MOSDBG("[SID] NUM%d #%d 1$%04x 2$%04x 3$%04x 4$%04x 5$%04x 6$%04x 7$%04x 8$%04x FM%d SOCK1:%d SOCK2:%d s1s1:%d s1s2:%d s2s1:%d s2s2:%d FSOCK2:%d\n",
     /* SID related defaults */
     sidcount,
     sidno,
@@ -289,6 +284,10 @@ void mos6581_8580::print_settings(void)
     sidtwo, /* 0xd420 */
     sidthree, /* 0xd440 */
     sidfour, /* 0xd460 */
+    sidfive, /* 0xd480 */
+    sidsix, /* 0xd4a0 */
+    sidseven, /* 0xd4c0 */
+    sideight, /* 0xd4e0 */
     /* USBSID related variables and defaults */
     fmoplsidno,
     sidssockone,
@@ -33,9 +33,11 @@
 #include <cstdint>
 
 #include <types.h>
+#include <c64util.h>
 
 class mmu;
 class mos6510;
+class sidbackend;
 
 /**
  * @brief C64 Sound Interface Device
@@ -46,6 +48,9 @@ class mos6581_8580
     mos6581_8580(void);
     ~mos6581_8580(void);
 
+    /* Logical SIDs, hardware output is limited to the 4 of one board */
+    static const int kMaxSids = 8;
+
     /* SID related defaults */
     uint8_t sidcount  = 1;
     uint8_t sidno     = 0;
@@ -53,6 +58,10 @@ class mos6581_8580
     uint16_t sidtwo   = 0x0000; /* 0xd420 */
     uint16_t sidthree = 0x0000; /* 0xd440 */
     uint16_t sidfour  = 0x0000; /* 0xd460 */
+    uint16_t sidfive  = 0x0000; /* 0xd480 */
+    uint16_t sidsix   = 0x0000; /* 0xd4a0 */
+    uint16_t sidseven = 0x0000; /* 0xd4c0 */
+    uint16_t sideight = 0x0000; /* 0xd4e0 */
     /* USBSID related variables and defaults */
     uint8_t fmoplsidno = 0;
     uint8_t sidssockone = 1;
@@ -62,6 +71,8 @@ class mos6581_8580
     uint8_t socktwosidone = 0;
     uint8_t socktwosidtwo = 0;
     bool forcesockettwo = false;
+    /* Where the register stream goes, nothing is sent while unset */
+    sidbackend * out = nullptr;
 
     bool log_sidrw = false;
 
@@ -77,6 +88,9 @@ class mos6581_8580
     CPUCLOCK s_cyclecount = 0;
     CPUCLOCK w_cyclecount = 0;
     CPUCLOCK r_cyclecount = 0;
+    /* $d400/$dfff address translation, low byte is the physical
+       address, high byte the SID number or 0 when unmapped */
+    uint16_t sidmap[0xC00];
     /* IO Banking */
     uint8_t bsc = 0;
     uint8_t crg = 0;
@@ -85,12 +99,14 @@ class mos6581_8580
   public:
     void glue_c64(mmu * _mmu, mos6510 * _cpu);
 
+    int sid_bases(uint16_t *bases);
     bool custom_sidaddr_check(uint16_t addr);
-    inline uint8_t sidaddr_translation(uint16_t addr);
+    uint16_t sidaddr_translation(uint16_t addr);
+    void map_sids(void);
     void sid_flush(void);
     unsigned int sid_delay(void);
-    uint8_t read_sid(uint16_t addr);
-    void write_sid(uint16_t addr, uint8_t data);
+    template<class Trace = trace_off> uint8_t read_sid(uint16_t addr);
+    template<class Trace = trace_off> void write_sid(uint16_t addr, uint8_t data);
 
     void print_settings(void);
 };
@@ -296,6 +296,8 @@ void __us_not_in_flash_func(switch_banks) mos906114::switch_banks(uint8_t v)
         v, (v&0x1f));
       break;
   }
+  /* Rebuild the mmu memory map for the new banks */
+  mmu_->map_banks(banks_[kBankBasic], banks_[kBankChargen], banks_[kBankKernal]);
 }
 
 /**
@@ -350,7 +352,10 @@ void __us_not_in_flash_func(runtime_bank_switching) mos906114::runtime_bank_swit
   uint8_t b = banks_at_boot; /* Use boot time state as preset */
   b &= (0x18|(v&0x7)); /* Preserve _cart bits_ and only set cpu latches */
   if (log_pla) MOSDBG("[PLA] Bank switch @ runtime from %02X to: %02X with %02X requested\n",banks_at_boot,b,v);
-  switch_banks(b);
+  /* Only the cpu latches select the banks, nothing to remap if they did not change */
+  if ((v ^ banks_at_runtime) & 0x7) {
+    switch_banks(b);
+  }
   /* write the raw value to the zero page (doesn't influence the cart bits) */
   mmu_->dma_write_ram(0x0001, v);
   banks_at_runtime = v;
@@ -0,0 +1,223 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * scheduler.cpp
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <scheduler.h>
+#include <c64util.h>
+
+
+/**
+ * @brief Construct a new scheduler::scheduler object
+ *
+ */
+scheduler::scheduler(void)
+{
+  for (int i = 0; i < kMaxAlarms; i++) {
+    alarms_[i] = { nullptr, nullptr, nullptr, RUN_FOREVER, -1 };
+    heap_[i] = -1;
+  }
+  return;
+}
+
+/**
+ * @brief Destroy the scheduler::scheduler object
+ *
+ */
+scheduler::~scheduler(void)
+{
+  return;
+}
+
+/**
+ * @brief Register a new alarm, it starts out unset
+ *
+ * @param name used in the debug dump
+ * @param callback called from dispatch() once the alarm is due
+ * @param context passed to the callback
+ * @return alarm_t handle or -1 if all alarms are in use
+ */
+alarm_t scheduler::add(const char *name, AlarmCallback callback, void *context)
+{
+  if (num_alarms_ >= kMaxAlarms) {
+    MOSDBG("[ALARM] ERROR! No free alarm for %s\n", name);
+    return -1;
+  }
+  alarm_t alarm = num_alarms_++;
+  alarms_[alarm] = { name, callback, context, RUN_FOREVER, -1 };
+  return alarm;
+}
+
+/**
+ * @brief Set or move an alarm to cycle clk
+ *
+ * @param alarm
+ * @param clk
+ */
+void __us_not_in_flash_func(set) scheduler::set(alarm_t alarm, CPUCLOCK clk)
+{
+  if _MOS_UNLIKELY (alarm < 0) return;
+  alarm_entry_t &e = alarms_[alarm];
+  CPUCLOCK old = e.clk;
+  e.clk = clk;
+  if (e.heap_pos < 0) {
+    e.heap_pos = heap_size_;
+    heap_[heap_size_++] = alarm;
+    sift_up(e.heap_pos);
+  } else if (clk < old) {
+    sift_up(e.heap_pos);
+  } else if (clk > old) {
+    sift_down(e.heap_pos);
+  }
+  next_clk_ = alarms_[heap_[0]].clk;
+  return;
+}
+
+/**
+ * @brief Remove an alarm from the queue
+ *
+ * @param alarm
+ */
+void __us_not_in_flash_func(unset) scheduler::unset(alarm_t alarm)
+{
+  if _MOS_UNLIKELY (alarm < 0) return;
+  if (alarms_[alarm].heap_pos < 0) return;
+  heap_remove(alarms_[alarm].heap_pos);
+  return;
+}
+
+/**
+ * @brief Returns the cycle an alarm is set for, RUN_FOREVER if unset
+ *
+ * @param alarm
+ * @return CPUCLOCK
+ */
+CPUCLOCK scheduler::clk(alarm_t alarm)
+{
+  if (alarm < 0 || alarms_[alarm].heap_pos < 0) return RUN_FOREVER;
+  return alarms_[alarm].clk;
+}
+
+/**
+ * @brief Fire every alarm that is due at cycle now, earliest first
+ *
+ * An alarm is unset before its callback runs, the callback sets
+ * it again for the next cycle it is interested in. That cycle must
+ * lie after now or the alarm fires again within this call.
+ *
+ * @param now
+ */
+void __us_not_in_flash_func(dispatch) scheduler::dispatch(CPUCLOCK now)
+{
+  while (heap_size_ > 0 && next_clk_ <= now) {
+    alarm_t alarm = heap_[0];
+    alarm_entry_t &e = alarms_[alarm];
+    CPUCLOCK clk = e.clk;
+    heap_remove(0);
+    dispatched_++;
+    e.callback(e.context, clk);
+  }
+  return;
+}
+
+/**
+ * @brief Swap two heap slots and update their back references
+ *
+ */
+void scheduler::heap_swap(int_fast8_t i, int_fast8_t j)
+{
+  alarm_t t = heap_[i];
+  heap_[i] = heap_[j];
+  heap_[j] = t;
+  alarms_[heap_[i]].heap_pos = i;
+  alarms_[heap_[j]].heap_pos = j;
+  return;
+}
+
+void scheduler::sift_up(int_fast8_t i)
+{
+  while (i > 0) {
+    int_fast8_t parent = ((i - 1) >> 1);
+    if (alarms_[heap_[parent]].clk <= alarms_[heap_[i]].clk) break;
+    heap_swap(i, parent);
+    i = parent;
+  }
+  return;
+}
+
+void scheduler::sift_down(int_fast8_t i)
+{
+  for (;;) {
+    int_fast8_t l = ((i << 1) + 1), r = (l + 1), m = i;
+    if (l < heap_size_ && alarms_[heap_[l]].clk < alarms_[heap_[m]].clk) m = l;
+    if (r < heap_size_ && alarms_[heap_[r]].clk < alarms_[heap_[m]].clk) m = r;
+    if (m == i) break;
+    heap_swap(i, m);
+    i = m;
+  }
+  return;
+}
+
+/**
+ * @brief Remove heap slot i, the last slot takes its place
+ *
+ */
+void scheduler::heap_remove(int_fast8_t i)
+{
+  alarm_t alarm = heap_[i];
+  alarms_[alarm].heap_pos = -1;
+  alarms_[alarm].clk = RUN_FOREVER;
+  if (i != --heap_size_) {
+    heap_[i] = heap_[heap_size_];
+    alarms_[heap_[i]].heap_pos = i;
+    sift_down(i);
+    sift_up(i);
+  }
+  heap_[heap_size_] = -1;
+  next_clk_ = (heap_size_ > 0 ? alarms_[heap_[0]].clk : RUN_FOREVER);
+  return;
+}
+
+/**
+ * @brief debug logging of the alarm queue
+ *
+ */
+void scheduler::dump_alarms(void)
+{
+  MOSDBG("[ALARM] %llu dispatched, next @ %llu\n",
+    (unsigned long long)dispatched_, (unsigned long long)next_clk_);
+  for (alarm_t a = 0; a < num_alarms_; a++) {
+    if (alarms_[a].heap_pos < 0) {
+      MOSDBG("[ALARM] %-8s unset\n", alarms_[a].name);
+    } else {
+      MOSDBG("[ALARM] %-8s @ %llu\n", alarms_[a].name, (unsigned long long)alarms_[a].clk);
+    }
+  }
+  return;
+}
@@ -0,0 +1,101 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * scheduler.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <cstdint>
+
+#include <types.h>
+
+
+/* Alarm handle, returned by scheduler::add() */
+typedef int_fast8_t alarm_t;
+
+/* Alarm callback, clk is the cycle the alarm was set for */
+typedef void (*AlarmCallback)(void *context, CPUCLOCK clk);
+
+
+/**
+ * @brief Cycle keyed alarm queue
+ *
+ * Peripherals register an alarm once and set it to the next cycle
+ * at which they have something to do, the machine loop only calls
+ * out when the earliest alarm is due. Alarms live in a small binary
+ * min-heap, next() is the cached top so the due check is a single
+ * compare per instruction.
+ */
+class scheduler
+{
+  private:
+    static const int kMaxAlarms = 8;
+
+    typedef struct alarm_entry_t {
+      const char *name;
+      AlarmCallback callback;
+      void *context;
+      CPUCLOCK clk;
+      int_fast8_t heap_pos; /* -1 when not set */
+    } alarm_entry_t;
+
+    alarm_entry_t alarms_[kMaxAlarms];
+    alarm_t heap_[kMaxAlarms];
+    int_fast8_t num_alarms_ = 0;
+    int_fast8_t heap_size_ = 0;
+    CPUCLOCK next_clk_ = RUN_FOREVER;
+
+    uint64_t dispatched_ = 0;
+
+    void heap_swap(int_fast8_t i, int_fast8_t j);
+    void sift_up(int_fast8_t i);
+    void sift_down(int_fast8_t i);
+    void heap_remove(int_fast8_t i);
+
+  public:
+    scheduler(void);
+    ~scheduler(void);
+
+    alarm_t add(const char *name, AlarmCallback callback, void *context);
+    void set(alarm_t alarm, CPUCLOCK clk);
+    void unset(alarm_t alarm);
+    CPUCLOCK clk(alarm_t alarm);
+
+    /* Cycle of the earliest alarm, RUN_FOREVER when none is set */
+    inline CPUCLOCK next(void) { return next_clk_; };
+    inline bool due(CPUCLOCK now) { return (now >= next_clk_); };
+    void dispatch(CPUCLOCK now);
+
+    uint64_t dispatched(void) { return dispatched_; };
+    void dump_alarms(void);
+};
+
+
+#endif /* _SCHEDULER_H */
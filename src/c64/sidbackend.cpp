@@ -0,0 +1,756 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * sidbackend.cpp
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+#include <sidbackend.h>
+#include <wrappers.h>
+
+#if DESKTOP
+#include <USBSID.h>
+#elif EMBEDDED
+#include <config.h>
+extern "C" {
+uint8_t cycled_read_operation(uint8_t address, uint16_t cycles);
+void cycled_write_operation(uint8_t address, uint8_t data, uint16_t cycles);
+void reset_sid(void);
+void reset_sid_registers(void);
+void apply_clockrate(int n_clock, bool suspend_sids);
+extern Config usbsid_config;
+}
+#endif
+
+
+/**
+ * @brief Construct a new sidbackend_usbsid::sidbackend_usbsid object
+ *
+ */
+#if DESKTOP
+sidbackend_usbsid::sidbackend_usbsid(USBSID_NS::USBSID_Class *dev)
+  : usbsid(dev)
+{
+  return;
+}
+#elif EMBEDDED
+sidbackend_usbsid::sidbackend_usbsid(void)
+{
+  return;
+}
+#endif
+
+void __us_not_in_flash_func(usbsid_write) sidbackend_usbsid::write(uint8_t phyaddr, uint8_t data, uint16_t cycles)
+{
+#if DESKTOP
+  /* Delays are essentially not nescessary
+     with current vsync implementation */
+  // usbsid->USBSID_WaitForCycle(cycles);
+  usbsid->USBSID_WriteRingCycled(phyaddr, data, cycles);
+#elif EMBEDDED
+  (void)cycles;
+  // cycled_write_operation(phyaddr, data, cycles);
+  /* No cycles when embedding, not needed */
+  cycled_write_operation(phyaddr, data, 0);
+#endif
+  return;
+}
+
+void __us_not_in_flash_func(usbsid_read) sidbackend_usbsid::read(uint8_t phyaddr, uint16_t cycles)
+{
+  (void)cycles;
+#if DESKTOP
+  (void)phyaddr;
+#elif EMBEDDED
+  // cycled_read_operation(phyaddr,cycles);
+  /* No cycles when embedding, not needed */
+  cycled_read_operation(phyaddr, 0);
+#endif
+  return;
+}
+
+void sidbackend_usbsid::wait(uint16_t cycles)
+{
+#if DESKTOP
+  usbsid->USBSID_WaitForCycle(cycles);
+#elif EMBEDDED
+  (void)cycles;
+#endif
+  return;
+}
+
+void sidbackend_usbsid::flush(uint16_t cycles)
+{
+  (void)cycles; /* Pacing is done per frame, not per cycle */
+#if DESKTOP
+  usbsid->USBSID_SetFlush(); /* Always flush USB data buffer when called */
+#endif
+  return;
+}
+
+void sidbackend_usbsid::set_clock_rate(long clockspeed)
+{
+#if DESKTOP
+  usbsid->USBSID_SetClockRate(clockspeed, true);
+#elif EMBEDDED
+  int clockrates[] = { 1000000, 985248, 1022727, 1023440, 1022730 };
+  if (usbsid_config.clock_rate != clockspeed) {
+    for (int i = 0; i < (int)count_of(clockrates); i++) {
+      if (clockrates[i] == clockspeed) {
+        apply_clockrate(i, true);
+      }
+    }
+  }
+#endif
+  return;
+}
+
+void sidbackend_usbsid::reset(void)
+{
+#if DESKTOP
+  usbsid->USBSID_ResetAllRegisters();
+  usbsid->USBSID_Reset();
+#elif EMBEDDED
+  reset_sid();
+  emu_sleep_us(100);
+  reset_sid_registers();
+  emu_sleep_us(100);
+#endif
+  return;
+}
+
+void sidbackend_usbsid::mute(bool mute)
+{
+#if DESKTOP
+  if (mute) usbsid->USBSID_Mute();
+  else usbsid->USBSID_UnMute();
+#elif EMBEDDED
+  (void)mute;
+#endif
+  return;
+}
+
+void sidbackend_usbsid::close(void)
+{
+#if DESKTOP
+  usbsid->USBSID_Flush();
+  usbsid->USBSID_DisableThread();
+  usbsid->USBSID_ResetAllRegisters();
+  usbsid->USBSID_Reset();
+#elif EMBEDDED
+  reset_sid_registers();
+  emu_sleep_us(100);
+  reset_sid();
+  emu_sleep_us(100);
+#endif
+  return;
+}
+
+/**
+ * @brief Report what was discarded
+ *
+ */
+void sidbackend_null::close(void)
+{
+  MOSDBG("[SIDOUT] null: %llu writes %llu reads %llu frames\n",
+    (unsigned long long)writes, (unsigned long long)reads, (unsigned long long)frames);
+  return;
+}
+
+#if DESKTOP
+/**
+ * @brief Construct a new sidbackend_file::sidbackend_file object
+ *
+ * @param file opened for writing, closed by close()
+ */
+sidbackend_file::sidbackend_file(FILE *file)
+  : fp(file)
+{
+  return;
+}
+
+/**
+ * @brief Open path for writing and return a file backend for it
+ *
+ * @param path
+ * @return sidbackend_file* or nullptr if path cannot be created
+ */
+sidbackend_file *sidbackend_file::open(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    MOSDBG("[SIDOUT] ERROR! Cannot create %s\n", path);
+    return nullptr;
+  }
+  return new sidbackend_file(file);
+}
+
+void sidbackend_file::write(uint8_t phyaddr, uint8_t data, uint16_t cycles)
+{
+  fprintf(fp, "w %u %02x %02x\n", cycles, phyaddr, data);
+  return;
+}
+
+void sidbackend_file::read(uint8_t phyaddr, uint16_t cycles)
+{
+  fprintf(fp, "r %u %02x\n", cycles, phyaddr);
+  return;
+}
+
+void sidbackend_file::wait(uint16_t cycles)
+{
+  fprintf(fp, "d %u\n", cycles);
+  return;
+}
+
+void sidbackend_file::flush(uint16_t cycles)
+{
+  fprintf(fp, "f %u\n", cycles);
+  return;
+}
+
+void sidbackend_file::set_clock_rate(long clockspeed)
+{
+  fprintf(fp, "c %ld\n", clockspeed);
+  return;
+}
+
+void sidbackend_file::reset(void)
+{
+  fputs("x\n", fp);
+  return;
+}
+
+void sidbackend_file::close(void)
+{
+  if (fp) {
+    fclose(fp);
+    fp = nullptr;
+  }
+  return;
+}
+
+/**
+ * @brief Construct a new sidbackend_wav::sidbackend_wav object
+ *
+ * @param file opened for binary writing, closed by close()
+ * @param samplerate output rate in Hz
+ * @param mos8580 render 8580 chips instead of 6581
+ */
+sidbackend_wav::sidbackend_wav(FILE *file, int samplerate, bool mos8580)
+  : fp(file), rate(samplerate)
+{
+  for (int i = 0; i < kMaxChips; i++) {
+    chips[i].set_model(mos8580);
+  }
+  set_clock_rate(clock);
+  write_header();
+  return;
+}
+
+/**
+ * @brief Destroy the sidbackend_wav::sidbackend_wav object
+ *
+ */
+sidbackend_wav::~sidbackend_wav(void)
+{
+  close();
+  delete resampler;
+  return;
+}
+
+/**
+ * @brief Create path and return a WAV backend for it
+ *
+ * @param path
+ * @param samplerate
+ * @param mos8580
+ * @return sidbackend_wav* or nullptr if path cannot be created
+ */
+sidbackend_wav *sidbackend_wav::open(const char *path, int samplerate, bool mos8580)
+{
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    MOSDBG("[SIDOUT] ERROR! Cannot create %s\n", path);
+    return nullptr;
+  }
+  MOSDBG("[SIDOUT] Rendering %s at %dHz as %s\n", path, samplerate, (mos8580 ? "8580" : "6581"));
+  return new sidbackend_wav(file, samplerate, mos8580);
+}
+
+void sidbackend_wav::write(uint8_t phyaddr, uint8_t data, uint16_t cycles)
+{
+  render(cycles);
+  int chip = (phyaddr >> 5);
+  if (chip >= kMaxChips) return;
+  if (chip >= numchips) numchips = (chip + 1);
+  chips[chip].write((phyaddr & 0x1f), data);
+  return;
+}
+
+void sidbackend_wav::set_clock_rate(long clockspeed)
+{
+  if (resampler && clockspeed == clock) return;
+  clock = clockspeed;
+  for (int i = 0; i < kMaxChips; i++) {
+    chips[i].set_clock_rate(clockspeed);
+  }
+  delete resampler;
+  resampler = new sidresampler((double)clockspeed, (double)rate);
+  return;
+}
+
+void sidbackend_wav::reset(void)
+{
+  for (int i = 0; i < kMaxChips; i++) {
+    chips[i].reset();
+  }
+  return;
+}
+
+/**
+ * @brief Run all used chips for cycles and resample the mix
+ *
+ */
+void sidbackend_wav::render(uint_fast32_t cycles)
+{
+  if (!fp) return;
+  while (cycles > 0) {
+    int n = (int)MIN(cycles, (uint_fast32_t)kBatch);
+    memset(mix, 0, (n * sizeof(mix[0])));
+    for (int i = 0; i < numchips; i++) {
+      chips[i].clock(n, mix);
+    }
+    for (int i = 0; i < n; i++) {
+      if (resampler->input(mix[i], samples[num_samples])) {
+        if (++num_samples == kBatch) write_samples();
+      }
+    }
+    cycles -= n;
+  }
+  return;
+}
+
+/**
+ * @brief Append the buffered samples, little endian
+ *
+ */
+void sidbackend_wav::write_samples(void)
+{
+  uint8_t out[(kBatch * 2)];
+  for (int i = 0; i < num_samples; i++) {
+    out[(i * 2)] = (samples[i] & 0xff);
+    out[((i * 2) + 1)] = ((samples[i] >> 8) & 0xff);
+  }
+  fwrite(out, 2, num_samples, fp);
+  data_bytes += (num_samples * 2);
+  num_samples = 0;
+  return;
+}
+
+/**
+ * @brief Write the RIFF header, sizes are patched in by close()
+ *
+ */
+void sidbackend_wav::write_header(void)
+{
+  uint8_t h[44];
+  const uint32_t fields[] = {
+    (36 + data_bytes), 16, (uint32_t)(1 | (1 << 16)), (uint32_t)rate,
+    (uint32_t)(rate * 2), (uint32_t)(2 | (16 << 16)), data_bytes
+  };
+  const int offsets[] = { 4, 16, 20, 24, 28, 32, 40 };
+  memcpy(&h[0], "RIFF", 4);
+  memcpy(&h[8], "WAVEfmt ", 8);
+  memcpy(&h[36], "data", 4);
+  for (size_t f = 0; f < count_of(fields); f++) {
+    for (int b = 0; b < 4; b++) h[(offsets[f] + b)] = ((fields[f] >> (b * 8)) & 0xff);
+  }
+  fseek(fp, 0, SEEK_SET);
+  fwrite(h, 1, sizeof(h), fp);
+  return;
+}
+
+void sidbackend_wav::close(void)
+{
+  if (fp) {
+    write_samples();
+    write_header();
+    fclose(fp);
+    fp = nullptr;
+    MOSDBG("[SIDOUT] wav: %u samples written\n", (data_bytes / 2));
+  }
+  return;
+}
+
+/**
+ * @brief Construct a new sidbackend_dump::sidbackend_dump object
+ *
+ * @param file opened for binary writing, closed by close()
+ */
+sidbackend_dump::sidbackend_dump(FILE *file)
+  : fp(file)
+{
+  memset(regs, 0, sizeof(regs));
+  return;
+}
+
+/**
+ * @brief Create path and return a dump backend for it
+ *
+ * @param path
+ * @return sidbackend_dump* or nullptr if path cannot be created
+ */
+sidbackend_dump *sidbackend_dump::open(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    MOSDBG("[SIDOUT] ERROR! Cannot create %s\n", path);
+    return nullptr;
+  }
+  return new sidbackend_dump(file);
+}
+
+/**
+ * @brief Write the header, delayed until the first record so the
+ * clock rate and layout of the tune are known
+ *
+ */
+void sidbackend_dump::write_header(void)
+{
+  uint8_t h[kSidDumpHeaderSize] = { 0 };
+  memcpy(&h[0], kSidDumpMagic, sizeof(kSidDumpMagic));
+  h[4] = kSidDumpVersion;
+  h[5] = (uint8_t)layout_sids;
+  for (int b = 0; b < 4; b++) {
+    h[(8 + b)] = ((clock >> (b * 8)) & 0xff);
+    h[(12 + b)] = ((clock >> (b * 8)) & 0xff); /* One keyframe per second */
+  }
+  for (int i = 0; i < kSidDumpMaxSids; i++) {
+    h[(16 + (i * 2))] = (layout[i] & 0xff);
+    h[(17 + (i * 2))] = (layout[i] >> 8);
+  }
+  fwrite(h, 1, sizeof(h), fp);
+  header_done = true;
+  return;
+}
+
+void sidbackend_dump::write(uint8_t phyaddr, uint8_t data, uint16_t cycles)
+{
+  if (!fp) return;
+  if (!header_done) write_header();
+  pending += cycles;
+  uint8_t buf[12];
+  int n = siddump_put_varint(buf, (pending << 1));
+  buf[n++] = phyaddr;
+  buf[n++] = data;
+  fwrite(buf, 1, n, fp);
+  now += pending;
+  pending = 0;
+  regs[phyaddr] = data;
+  if ((phyaddr >> 5) >= numchips) numchips = ((phyaddr >> 5) + 1);
+  records++;
+  return;
+}
+
+/**
+ * @brief Special record carrying the pending cycles
+ *
+ */
+void sidbackend_dump::put_special(uint8_t type)
+{
+  if (!header_done) write_header();
+  uint8_t buf[12];
+  int n = siddump_put_varint(buf, ((pending << 1) | 1));
+  buf[n++] = type;
+  fwrite(buf, 1, n, fp);
+  now += pending;
+  pending = 0;
+  return;
+}
+
+/**
+ * @brief Register state at the current cycle
+ *
+ */
+void sidbackend_dump::keyframe(void)
+{
+  put_special(kSidDumpKeyframe);
+  uint8_t buf[12];
+  int n = siddump_put_varint(buf, now);
+  buf[n++] = (uint8_t)numchips;
+  fwrite(buf, 1, n, fp);
+  fwrite(regs, 1, (numchips * 0x20), fp);
+  last_keyframe = now;
+  return;
+}
+
+void sidbackend_dump::flush(uint16_t cycles)
+{
+  if (!fp) return;
+  pending += cycles;
+  if (header_done && ((now + pending - last_keyframe) >= (uint64_t)clock)) {
+    keyframe();
+  }
+  return;
+}
+
+void sidbackend_dump::set_clock_rate(long clockspeed)
+{
+  clock = clockspeed;
+  if (fp && header_done) {
+    put_special(kSidDumpClock);
+    uint8_t buf[10];
+    fwrite(buf, 1, siddump_put_varint(buf, (uint64_t)clockspeed), fp);
+  }
+  return;
+}
+
+void sidbackend_dump::set_layout(int numsids, const uint16_t *bases)
+{
+  layout_sids = MIN(numsids, kSidDumpMaxSids);
+  for (int i = 0; i < kSidDumpMaxSids; i++) {
+    layout[i] = (i < layout_sids ? bases[i] : 0);
+  }
+  return;
+}
+
+void sidbackend_dump::reset(void)
+{
+  memset(regs, 0, sizeof(regs));
+  return;
+}
+
+void sidbackend_dump::close(void)
+{
+  if (fp) {
+    put_special(kSidDumpEnd);
+    MOSDBG("[SIDOUT] dump: %llu writes, %llu cycles, %ld bytes\n",
+      (unsigned long long)records, (unsigned long long)now, ftell(fp));
+    fclose(fp);
+    fp = nullptr;
+  }
+  return;
+}
+
+/**
+ * @brief Construct a new sidbackend_ring::sidbackend_ring object and
+ * start its output thread
+ *
+ * @param backend paced output, owned and deleted by the ring
+ * @param frames look-ahead in frames
+ */
+sidbackend_ring::sidbackend_ring(sidbackend *backend, int frames)
+  : out(backend), frames_ahead(MAX(frames, 1))
+{
+  ring = new entry_t[kRingSize];
+  thread = std::thread(&sidbackend_ring::output_thread, this);
+  MOSDBG("[SIDOUT] %s with %d frames look-ahead\n", out->name(), frames_ahead);
+  return;
+}
+
+/**
+ * @brief Destroy the sidbackend_ring::sidbackend_ring object
+ *
+ */
+sidbackend_ring::~sidbackend_ring(void)
+{
+  close();
+  delete out;
+  delete[] ring;
+  return;
+}
+
+/**
+ * @brief Queue an entry, waits while the ring is full
+ *
+ */
+void sidbackend_ring::push(uint8_t kind, uint8_t addr, uint32_t value, uint16_t cycles)
+{
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  while ((t - head.load(std::memory_order_acquire)) >= kRingSize) {
+    if (!running.load(std::memory_order_relaxed)) return;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  entry_t &e = ring[(t & (kRingSize - 1))];
+  e.kind = kind;
+  e.addr = addr;
+  e.value = value;
+  e.cycles = cycles;
+  tail.store((t + 1), std::memory_order_release);
+  produced_cycles.fetch_add(cycles, std::memory_order_relaxed);
+  return;
+}
+
+/**
+ * @brief Queue the end of a frame, holds the emulation back once it
+ * is frames_ahead in front of the output until half has played
+ *
+ */
+void sidbackend_ring::flush(uint16_t cycles)
+{
+  push(kEntryFlush, 0, 0, cycles);
+  uint32_t produced = (produced_frames.load(std::memory_order_relaxed) + 1);
+  produced_frames.store(produced, std::memory_order_release);
+  uint32_t d = depth();
+  if (d > max_depth.load(std::memory_order_relaxed)) max_depth.store(d, std::memory_order_relaxed);
+  if ((int)(produced - played_frames.load(std::memory_order_acquire)) < frames_ahead) return;
+  while (running.load(std::memory_order_relaxed)
+    && (int)(produced - played_frames.load(std::memory_order_acquire)) > (frames_ahead / 2)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return;
+}
+
+void sidbackend_ring::set_clock_rate(long clockspeed)
+{
+  clock_.store(clockspeed, std::memory_order_relaxed);
+  push(kEntryClock, 0, (uint32_t)clockspeed, 0);
+  return;
+}
+
+/**
+ * @brief Request a mute, applied by the output thread so only it
+ * touches the device. The backlog is held while muted and plays on
+ * after the unmute, queued writes cannot undo the mute
+ *
+ */
+void sidbackend_ring::mute(bool mute)
+{
+  muted.store(mute, std::memory_order_release);
+  return;
+}
+
+uint32_t sidbackend_ring::depth(void)
+{
+  return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+}
+
+uint64_t sidbackend_ring::lead_cycles(void)
+{
+  return (produced_cycles.load(std::memory_order_relaxed) - played_cycles.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Feed queued entries to the backend, paced per frame
+ *
+ * An empty ring while playing is an underrun, timing restarts from
+ * the next entry so the output does not rush to catch up. The same
+ * goes for the first entry after an unmute
+ */
+void sidbackend_ring::output_thread(void)
+{
+  typedef std::chrono::steady_clock clk;
+  long clock = 985248;
+  uint64_t played = 0, synced = 0;
+  clk::time_point start = clk::now();
+  bool started = false, starved = false, silenced = false;
+
+  while (running.load(std::memory_order_acquire)) {
+    bool m = muted.load(std::memory_order_acquire);
+    if (m != silenced) {
+      out->mute(m);
+      silenced = m;
+      starved = true; /* Restart timing once unmuted */
+    }
+    if (silenced) {
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+      continue;
+    }
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+      if (started && !starved && !draining.load(std::memory_order_relaxed)) {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+      }
+      starved = true;
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+      continue;
+    }
+    if (starved) {
+      start = clk::now();
+      synced = played;
+      starved = false;
+    }
+    started = true;
+    const entry_t e = ring[(h & (kRingSize - 1))];
+    head.store((h + 1), std::memory_order_release);
+    played += e.cycles;
+    switch (e.kind) {
+      case kEntryWrite: out->write(e.addr, (uint8_t)e.value, e.cycles); break;
+      case kEntryRead: out->read(e.addr, e.cycles); break;
+      case kEntryWait: out->wait(e.cycles); break;
+      case kEntryClock:
+        clock = (long)e.value;
+        out->set_clock_rate(clock);
+        break;
+      case kEntryReset: out->reset(); break;
+      case kEntryFlush:
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<clk::duration>(
+          std::chrono::duration<double>((double)(played - synced) / (double)clock)));
+        out->flush(e.cycles);
+        played_frames.fetch_add(1, std::memory_order_release);
+        break;
+    }
+    played_cycles.store(played, std::memory_order_relaxed);
+  }
+  return;
+}
+
+void sidbackend_ring::dump_stats(void)
+{
+  MOSDBG("[SIDOUT] ring: depth %u (max %u) lead %.1fms %llu underruns\n",
+    depth(), max_depth.load(std::memory_order_relaxed), (lead_cycles() * 1000.0 / clock_.load(std::memory_order_relaxed)),
+    (unsigned long long)underruns());
+  return;
+}
+
+/**
+ * @brief Play out what is still queued and stop the output thread.
+ * The queue is dropped instead after abort() or while muted
+ *
+ */
+void sidbackend_ring::close(void)
+{
+  if (thread.joinable()) {
+    draining.store(true, std::memory_order_relaxed);
+    while (!aborted.load(std::memory_order_relaxed)
+      && !muted.load(std::memory_order_relaxed) && (depth() > 0)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    running.store(false, std::memory_order_release);
+    thread.join();
+    dump_stats();
+    out->close();
+  }
+  return;
+}
+#endif
@@ -0,0 +1,319 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * sidbackend.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _SIDBACKEND_H
+#define _SIDBACKEND_H
+
+#include <cstdio>
+#include <cstdint>
+
+#include <types.h>
+#include <c64util.h>
+
+#if DESKTOP
+#include <atomic>
+#include <thread>
+
+#include <sidengine.h>
+#include <siddump.h>
+
+namespace USBSID_NS { class USBSID_Class; }
+#endif
+
+
+/**
+ * @brief Destination for the SID register stream
+ *
+ * mos6581_8580 hands every SID access to a backend as a physical
+ * address ($00/$ff, $20 per SID) with the cycles passed since the
+ * previous access. Backends that care about time add those up,
+ * the rest ignore them.
+ */
+class sidbackend
+{
+  public:
+    virtual ~sidbackend(void) {};
+
+    virtual const char *name(void) = 0;
+    /* Hardware needs the emulation paced to real time, the rest can
+     * run as fast as the host allows */
+    virtual bool realtime(void) { return false; };
+
+    virtual void write(uint8_t phyaddr, uint8_t data, uint16_t cycles) = 0;
+    virtual void read(uint8_t phyaddr, uint16_t cycles) { (void)phyaddr; (void)cycles; };
+    /* Cycles that passed without any access, called per $ffff */
+    virtual void wait(uint16_t cycles) { (void)cycles; };
+    /* End of frame, cycles passed since the last access */
+    virtual void flush(uint16_t cycles) { (void)cycles; };
+    virtual void set_clock_rate(long clockspeed) { (void)clockspeed; };
+    /* SID base addresses of the tune, set before it starts playing */
+    virtual void set_layout(int numsids, const uint16_t *bases) { (void)numsids; (void)bases; };
+    virtual void reset(void) {};
+    virtual void mute(bool mute) { (void)mute; };
+    /* Drop queued output, the next close() does not wait for it */
+    virtual void abort(void) {};
+    /* Called once before the backend is deleted */
+    virtual void close(void) {};
+    virtual void dump_stats(void) {};
+};
+
+/**
+ * @brief USBSID-Pico, over USB on desktop or the local bus when embedded
+ */
+class sidbackend_usbsid : public sidbackend
+{
+  public:
+#if DESKTOP
+    sidbackend_usbsid(USBSID_NS::USBSID_Class *dev);
+#elif EMBEDDED
+    sidbackend_usbsid(void);
+#endif
+
+    const char *name(void) { return "usbsid"; };
+    bool realtime(void) { return true; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles);
+    void read(uint8_t phyaddr, uint16_t cycles);
+    void wait(uint16_t cycles);
+    void flush(uint16_t cycles);
+    void set_clock_rate(long clockspeed);
+    void reset(void);
+    void mute(bool mute);
+    void close(void);
+
+  private:
+#if DESKTOP
+    USBSID_NS::USBSID_Class *usbsid;
+#endif
+};
+
+/**
+ * @brief Discards everything, counts accesses for benchmark runs
+ */
+class sidbackend_null : public sidbackend
+{
+  public:
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+    uint64_t frames = 0;
+
+    const char *name(void) { return "null"; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles) { (void)phyaddr; (void)data; (void)cycles; writes++; };
+    void read(uint8_t phyaddr, uint16_t cycles) { (void)phyaddr; (void)cycles; reads++; };
+    void flush(uint16_t cycles) { (void)cycles; frames++; };
+    void close(void);
+};
+
+#if DESKTOP
+/**
+ * @brief Logs the register stream to a text file, one access per line
+ *
+ * Lines are "w <cycles> <addr> <data>" and "r <cycles> <addr>" with
+ * cycles in decimal since the previous line and addr/data in hex.
+ * "d <cycles>" is a wait, "f <cycles>" the end of a frame, "c <hz>" a clock
+ * rate change and "x" a reset. Output is plain so two runs diff.
+ */
+class sidbackend_file : public sidbackend
+{
+  public:
+    sidbackend_file(FILE *file);
+
+    static sidbackend_file *open(const char *path);
+
+    const char *name(void) { return "file"; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles);
+    void read(uint8_t phyaddr, uint16_t cycles);
+    void wait(uint16_t cycles);
+    void flush(uint16_t cycles);
+    void set_clock_rate(long clockspeed);
+    void reset(void);
+    void close(void);
+
+  private:
+    FILE *fp;
+};
+
+/**
+ * @brief Renders the register stream with sidengine to a 16 bit
+ * mono WAV file
+ *
+ * Each $20 block of physical addresses drives its own chip, up to
+ * eight. The chips run in batches between accesses and are mixed
+ * before resampling to the output rate.
+ */
+class sidbackend_wav : public sidbackend
+{
+  public:
+    sidbackend_wav(FILE *file, int samplerate, bool mos8580);
+    ~sidbackend_wav(void);
+
+    static sidbackend_wav *open(const char *path, int samplerate, bool mos8580);
+
+    const char *name(void) { return "wav"; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles);
+    void read(uint8_t phyaddr, uint16_t cycles) { (void)phyaddr; render(cycles); };
+    void wait(uint16_t cycles) { render(cycles); };
+    void flush(uint16_t cycles) { render(cycles); };
+    void set_clock_rate(long clockspeed);
+    void reset(void);
+    void close(void);
+
+  private:
+    static const int kMaxChips = 8;
+    static const int kBatch = 1024;
+
+    FILE *fp;
+    int rate;
+    long clock = 985248;
+    sidengine chips[kMaxChips];
+    int numchips = 1;
+    sidresampler *resampler = nullptr;
+    int32_t mix[kBatch];
+    int16_t samples[kBatch];
+    int num_samples = 0;
+    uint32_t data_bytes = 0;
+
+    void render(uint_fast32_t cycles);
+    void write_samples(void);
+    void write_header(void);
+};
+
+/**
+ * @brief Captures the register stream to a cycle stamped dump,
+ * see siddump.h for the format
+ */
+class sidbackend_dump : public sidbackend
+{
+  public:
+    sidbackend_dump(FILE *file);
+
+    static sidbackend_dump *open(const char *path);
+
+    const char *name(void) { return "dump"; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles);
+    void read(uint8_t phyaddr, uint16_t cycles) { (void)phyaddr; pending += cycles; };
+    void wait(uint16_t cycles) { pending += cycles; };
+    void flush(uint16_t cycles);
+    void set_clock_rate(long clockspeed);
+    void set_layout(int numsids, const uint16_t *bases);
+    void reset(void);
+    void close(void);
+
+  private:
+    FILE *fp;
+    bool header_done = false;
+    long clock = 985248;
+    int layout_sids = 1;
+    uint16_t layout[kSidDumpMaxSids] = { 0xd400 };
+    uint8_t regs[(kSidDumpMaxSids * 0x20)];
+    int numchips = 1;
+    uint64_t now = 0;     /* Absolute cycle of the last record */
+    uint64_t pending = 0; /* Cycles since the last record */
+    uint64_t last_keyframe = 0;
+    uint64_t records = 0;
+
+    void write_header(void);
+    void put_special(uint8_t type);
+    void keyframe(void);
+};
+
+/**
+ * @brief Runs the emulation ahead of a hardware backend
+ *
+ * The emulation thread queues the register stream in a lock free
+ * single producer single consumer ring and continues, an output
+ * thread feeds it to the wrapped backend paced to host time one
+ * frame at a time. The emulation is held back once it is ahead by
+ * the look-ahead and released when half of that has played, so it
+ * runs in bursts and host hiccups shorter than the look-ahead do
+ * not reach the audio.
+ */
+class sidbackend_ring : public sidbackend
+{
+  public:
+    sidbackend_ring(sidbackend *backend, int frames);
+    ~sidbackend_ring(void);
+
+    const char *name(void) { return "ring"; };
+    void write(uint8_t phyaddr, uint8_t data, uint16_t cycles) { push(kEntryWrite, phyaddr, data, cycles); };
+    void read(uint8_t phyaddr, uint16_t cycles) { push(kEntryRead, phyaddr, 0, cycles); };
+    void wait(uint16_t cycles) { push(kEntryWait, 0, 0, cycles); };
+    void flush(uint16_t cycles);
+    void set_clock_rate(long clockspeed);
+    void set_layout(int numsids, const uint16_t *bases) { out->set_layout(numsids, bases); };
+    void reset(void) { push(kEntryReset, 0, 0, 0); };
+    void mute(bool mute);
+    void abort(void) { aborted.store(true, std::memory_order_relaxed); };
+    void close(void);
+    void dump_stats(void);
+
+    /* Entries waiting in the ring */
+    uint32_t depth(void);
+    /* Emulated cycles queued but not yet played */
+    uint64_t lead_cycles(void);
+    uint64_t underruns(void) { return underruns_.load(std::memory_order_relaxed); };
+
+  private:
+    static const uint32_t kRingSize = (1 << 16); /* power of two */
+
+    typedef enum { kEntryWrite, kEntryRead, kEntryWait, kEntryFlush, kEntryClock, kEntryReset } entry_kind_t;
+    typedef struct entry_t {
+      uint32_t value;
+      uint16_t cycles;
+      uint8_t kind;
+      uint8_t addr;
+    } entry_t;
+
+    sidbackend *out;
+    int frames_ahead;
+    entry_t *ring;
+    std::atomic<uint32_t> head{0}; /* written by the output thread */
+    std::atomic<uint32_t> tail{0}; /* written by the emulation thread */
+    std::atomic<uint64_t> produced_cycles{0};
+    std::atomic<uint64_t> played_cycles{0};
+    std::atomic<uint32_t> produced_frames{0};
+    std::atomic<uint32_t> played_frames{0};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<long> clock_{985248};
+    std::atomic<bool> running{true};
+    std::atomic<bool> muted{false}; /* set by mute(), applied by the output thread */
+    std::atomic<bool> aborted{false};
+    std::atomic<bool> draining{false};
+    std::atomic<uint32_t> max_depth{0};
+    std::thread thread;
+
+    void push(uint8_t kind, uint8_t addr, uint32_t value, uint16_t cycles);
+    void output_thread(void);
+};
+#endif
+
+
+#endif /* _SIDBACKEND_H */
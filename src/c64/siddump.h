@@ -0,0 +1,104 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * siddump.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _SIDDUMP_H
+#define _SIDDUMP_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * Cycle stamped SID register dump, all values little endian
+ *
+ * Header, kSidDumpHeaderSize bytes:
+ *   0  "USSD"
+ *   4  uint8_t  version
+ *   5  uint8_t  number of SIDs
+ *   6  uint16_t reserved
+ *   8  uint32_t clock rate in Hz
+ *   12 uint32_t cycles between keyframes
+ *   16 uint16_t base address per SID [8], 0 when unused
+ *
+ * Records start with a varint of (cycle delta << 1) | special:
+ *   special 0: uint8_t physical address ($20 per SID), uint8_t value
+ *   special 1: uint8_t type followed by
+ *     kSidDumpKeyframe: varint absolute cycle, uint8_t number of
+ *                       SIDs, then their 32 registers each
+ *     kSidDumpClock:    varint clock rate in Hz
+ *     kSidDumpEnd:      nothing, end of stream
+ *
+ * Keyframes hold the register state so playback can start at any
+ * keyframe instead of the beginning.
+ */
+static const char kSidDumpMagic[4] = { 'U', 'S', 'S', 'D' };
+static const uint8_t kSidDumpVersion = 1;
+static const int kSidDumpHeaderSize = 32;
+static const int kSidDumpMaxSids = 8;
+
+enum {
+  kSidDumpKeyframe = 0,
+  kSidDumpClock = 1,
+  kSidDumpEnd = 2,
+};
+
+/* LEB128 varint, returns the number of bytes written to buf[10] */
+static inline int siddump_put_varint(uint8_t *buf, uint64_t v)
+{
+  int n = 0;
+  while (v >= 0x80) {
+    buf[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  buf[n++] = (uint8_t)v;
+  return n;
+}
+
+/* Decode a varint at *p, advances *p, stops at end */
+static inline uint64_t siddump_get_varint(const uint8_t **p, const uint8_t *end)
+{
+  uint64_t v = 0;
+  for (int shift = 0; *p < end && shift < 64; shift += 7) {
+    uint8_t b = *(*p)++;
+    v |= ((uint64_t)(b & 0x7f) << shift);
+    if (!(b & 0x80)) break;
+  }
+  return v;
+}
+
+static inline uint32_t siddump_get_u32(const uint8_t *p)
+{
+  return (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+
+#endif /* _SIDDUMP_H */
@@ -0,0 +1,423 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * sidengine.cpp
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <cmath>
+#include <cstring>
+
+#include <sidengine.h>
+
+
+/* Envelope rate counter periods per 4 bit rate, from reSID */
+static const uint16_t kRatePeriods[16] = {
+  9, 32, 63, 95, 149, 220, 267, 313, 392, 977, 1954, 3126, 3907, 11720, 19532, 31251
+};
+static const uint8_t kSustainLevels[16] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+  0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+/* Output scale so one chip at full volume spans 16 bits */
+static const float kOutputScale = (65536.0f / (4095.0f * 255.0f * 3.0f * 15.0f * 2.0f));
+
+
+/**
+ * @brief Construct a new sidengine::sidengine object
+ *
+ */
+sidengine::sidengine(void)
+{
+  set_model(false);
+  reset();
+  return;
+}
+
+/**
+ * @brief Destroy the sidengine::sidengine object
+ *
+ */
+sidengine::~sidengine(void)
+{
+  return;
+}
+
+/**
+ * @brief Select 6581 or 8580 DC offsets and filter curve
+ *
+ * @param mos8580
+ */
+void sidengine::set_model(bool mos8580)
+{
+  is8580 = mos8580;
+  if (is8580) {
+    wave_zero = 0x800;
+    voice_dc = 0.0f;
+    mixer_dc = 0.0f;
+  } else {
+    wave_zero = 0x380;
+    voice_dc = (float)(0x800 * 0xff);
+    /* Makes volume register writes audible for digis */
+    mixer_dc = (float)(-0xfff * 0xff / 18);
+  }
+  set_cutoff();
+  return;
+}
+
+/**
+ * @brief Set the chip clock, filter coefficients are per cycle
+ *
+ * @param clockspeed in Hz
+ */
+void sidengine::set_clock_rate(long clockspeed)
+{
+  cycles_per_sec = (double)clockspeed;
+  ext_w0lp = (float)(2.0 * M_PI * 16000.0 / cycles_per_sec);
+  ext_w0hp = (float)(2.0 * M_PI * 16.0 / cycles_per_sec);
+  set_cutoff();
+  return;
+}
+
+/**
+ * @brief Power on state
+ *
+ */
+void sidengine::reset(void)
+{
+  for (int i = 0; i < 3; i++) {
+    voice_t &v = voice[i];
+    memset(&v, 0, sizeof(v));
+    v.noise = 0x7ffff8;
+    v.state = kRelease;
+    v.rate_period = kRatePeriods[0];
+    v.exp_period = 1;
+    v.hold_zero = true;
+  }
+  fc = 0;
+  res_filt = 0;
+  mode_vol = 0;
+  vhp = vbp = vlp = 0.0f;
+  ext_lp = ext_hp = 0.0f;
+  set_clock_rate((long)cycles_per_sec);
+  return;
+}
+
+/**
+ * @brief Recalculate the filter coefficients from FC and resonance
+ *
+ */
+void sidengine::set_cutoff(void)
+{
+  double f;
+  if (is8580) {
+    f = ((fc * 5.8) + 30.0);
+  } else {
+    /* Fitted to the typical 6581 curve, ~220Hz up to ~18kHz */
+    f = (220.0 + 9000.0 * (1.0 + tanh((fc - 1200.0) / 350.0)));
+  }
+  if (f > 16000.0) f = 16000.0; /* Keeps the filter stable */
+  w0 = (float)(2.0 * M_PI * f / cycles_per_sec);
+  div_q = (float)(1.0 / (0.707 + ((res_filt >> 4) / 15.0)));
+  return;
+}
+
+/**
+ * @brief Start attack or release on a gate change
+ *
+ */
+void sidengine::set_gate(voice_t &v, bool gate)
+{
+  if (gate) {
+    v.state = kAttack;
+    v.rate_period = kRatePeriods[(v.attack_decay >> 4)];
+    v.hold_zero = false;
+  } else {
+    v.state = kRelease;
+    v.rate_period = kRatePeriods[(v.sustain_release & 0xf)];
+  }
+  return;
+}
+
+/**
+ * @brief Write a SID register
+ *
+ * @param reg $00/$1f
+ * @param data
+ */
+void sidengine::write(uint8_t reg, uint8_t data)
+{
+  reg &= 0x1f;
+  if (reg < 0x15) {
+    voice_t &v = voice[(reg / 7)];
+    switch (reg % 7) {
+      case 0: v.freq = ((v.freq & 0xff00) | data); break;
+      case 1: v.freq = ((v.freq & 0x00ff) | (data << 8)); break;
+      case 2: v.pw = ((v.pw & 0xf00) | data); break;
+      case 3: v.pw = ((v.pw & 0x0ff) | ((data & 0xf) << 8)); break;
+      case 4:
+        if ((data ^ v.control) & 0x01) set_gate(v, (data & 0x01));
+        if (data & 0x08) {
+          v.acc = 0;
+          v.noise = 0x7ffff8;
+        }
+        v.control = data;
+        break;
+      case 5:
+        v.attack_decay = data;
+        if (v.state == kAttack) v.rate_period = kRatePeriods[(data >> 4)];
+        else if (v.state == kDecaySustain) v.rate_period = kRatePeriods[(data & 0xf)];
+        break;
+      case 6:
+        v.sustain_release = data;
+        if (v.state == kRelease) v.rate_period = kRatePeriods[(data & 0xf)];
+        break;
+    }
+    return;
+  }
+  switch (reg) {
+    case 0x15: fc = ((fc & 0x7f8) | (data & 0x07)); set_cutoff(); break;
+    case 0x16: fc = ((fc & 0x007) | (data << 3)); set_cutoff(); break;
+    case 0x17: res_filt = data; set_cutoff(); break;
+    case 0x18: mode_vol = data; break;
+    default: break;
+  }
+  return;
+}
+
+/**
+ * @brief 12 bit waveform output of a voice
+ *
+ * @param v
+ * @param ring_source voice that ring modulates v
+ * @return uint_fast16_t
+ */
+inline uint_fast16_t sidengine::waveform(const voice_t &v, const voice_t &ring_source)
+{
+  uint_fast16_t out = 0xfff;
+  uint_fast8_t wave = (v.control >> 4);
+  if (wave == 0) return 0;
+  if (wave & 0x1) {
+    uint32_t msb = (v.acc & 0x800000);
+    if (v.control & 0x04) msb ^= (ring_source.acc & 0x800000);
+    out &= (((msb ? ~v.acc : v.acc) >> 11) & 0xfff);
+  }
+  if (wave & 0x2) {
+    out &= (v.acc >> 12);
+  }
+  if (wave & 0x4) {
+    out &= (((v.control & 0x08) || (v.acc >> 12) >= v.pw) ? 0xfff : 0x000);
+  }
+  if (wave & 0x8) {
+    uint32_t n = v.noise;
+    out &= (((n & 0x100000) >> 9) | ((n & 0x040000) >> 8) | ((n & 0x004000) >> 5)
+      | ((n & 0x000800) >> 3) | ((n & 0x000200) >> 2) | ((n & 0x000020) << 1)
+      | ((n & 0x000004) << 3) | ((n & 0x000001) << 4));
+  }
+  return out;
+}
+
+/**
+ * @brief Clock the envelope of a voice one cycle
+ *
+ */
+inline void sidengine::clock_envelope(voice_t &v)
+{
+  if (++v.rate_counter & 0x8000) v.rate_counter = 0; /* 15 bit counter */
+  if (v.rate_counter != v.rate_period) return;
+  v.rate_counter = 0;
+  if (v.state != kAttack && ++v.exp_counter != v.exp_period) return;
+  v.exp_counter = 0;
+  if (v.hold_zero) return;
+  switch (v.state) {
+    case kAttack:
+      v.env++;
+      if (v.env == 0xff) {
+        v.state = kDecaySustain;
+        v.rate_period = kRatePeriods[(v.attack_decay & 0xf)];
+      }
+      break;
+    case kDecaySustain:
+      if (v.env != kSustainLevels[(v.sustain_release >> 4)]) v.env--;
+      break;
+    case kRelease:
+      v.env--;
+      break;
+  }
+  switch (v.env) {
+    case 0xff: v.exp_period = 1; break;
+    case 0x5d: v.exp_period = 2; break;
+    case 0x36: v.exp_period = 4; break;
+    case 0x1a: v.exp_period = 8; break;
+    case 0x0e: v.exp_period = 16; break;
+    case 0x06: v.exp_period = 30; break;
+    case 0x00: v.exp_period = 1; v.hold_zero = true; break;
+    default: break;
+  }
+  return;
+}
+
+/**
+ * @brief Run the chip for a batch of cycles
+ *
+ * @param cycles
+ * @param mix one sample per cycle is added here
+ */
+void sidengine::clock(uint_fast32_t cycles, int32_t *mix)
+{
+  const uint8_t filt = (res_filt & 0x0f);
+  const uint8_t mode = (mode_vol & 0x70);
+  const bool voice3off = ((mode_vol & 0x80) && !(filt & 0x04));
+  const float vol = (float)(mode_vol & 0x0f);
+
+  for (uint_fast32_t c = 0; c < cycles; c++) {
+    /* Oscillators, sync needs all three accumulators first */
+    for (int i = 0; i < 3; i++) {
+      voice_t &v = voice[i];
+      if (v.control & 0x08) { v.msb_rising = false; continue; }
+      uint32_t prev = v.acc;
+      v.acc = ((v.acc + v.freq) & 0xffffff);
+      v.msb_rising = (!(prev & 0x800000) && (v.acc & 0x800000));
+      if (!(prev & 0x080000) && (v.acc & 0x080000)) {
+        uint32_t bit0 = (((v.noise >> 22) ^ (v.noise >> 17)) & 0x1);
+        v.noise = (((v.noise << 1) | bit0) & 0x7fffff);
+      }
+    }
+    for (int i = 0; i < 3; i++) {
+      /* Voice 1 is synced by voice 3, 2 by 1 and 3 by 2 */
+      const voice_t &src = voice[((i + 2) % 3)];
+      if ((voice[i].control & 0x02) && src.msb_rising) voice[i].acc = 0;
+    }
+
+    float vf = 0.0f, vnf = 0.0f;
+    for (int i = 0; i < 3; i++) {
+      voice_t &v = voice[i];
+      clock_envelope(v);
+      float out = ((float)((int32_t)waveform(v, voice[((i + 2) % 3)]) - wave_zero) * v.env + voice_dc);
+      if (filt & (1 << i)) vf += out;
+      else if (i != 2 || !voice3off) vnf += out;
+    }
+
+    /* State variable filter */
+    vhp = ((vbp * div_q) - vlp - vf);
+    vbp -= (w0 * vhp);
+    vlp -= (w0 * vbp);
+    float fo = 0.0f;
+    if (mode & 0x10) fo += vlp;
+    if (mode & 0x20) fo += vbp;
+    if (mode & 0x40) fo += vhp;
+
+    /* Mixer and C64 board RC filters */
+    float vo = ((vnf + fo + mixer_dc) * vol);
+    ext_lp += (ext_w0lp * (vo - ext_lp));
+    ext_hp += (ext_w0hp * (ext_lp - ext_hp));
+    mix[c] += (int32_t)((ext_lp - ext_hp) * kOutputScale);
+  }
+  return;
+}
+
+/**
+ * @brief Modified Bessel function of the first kind, order zero
+ *
+ */
+static double bessel_i0(double x)
+{
+  double sum = 1.0, u = 1.0, halfx = (x / 2.0);
+  for (int n = 1; u >= (1e-21 * sum); n++) {
+    double temp = (halfx / n);
+    u *= (temp * temp);
+    sum += u;
+  }
+  return sum;
+}
+
+/**
+ * @brief Construct a new sidresampler::sidresampler object
+ *
+ * @param clockspeed input rate in Hz
+ * @param samplerate output rate in Hz
+ */
+sidresampler::sidresampler(double clockspeed, double samplerate)
+{
+  const double ratio = (clockspeed / samplerate);
+  /* 16 bit stopband, transition band from 0.9 of nyquist */
+  const double A = (-20.0 * log10(1.0 / 65536.0));
+  const double dw = ((1.0 - 0.9) * M_PI * 2.0);
+  const double beta = (0.1102 * (A - 8.7));
+  const double i0beta = bessel_i0(beta);
+  int zero_crossings = (int)(((A - 7.95) / (2.285 * dw)) + 0.5);
+  zero_crossings += (zero_crossings & 1);
+
+  taps = (((int)(zero_crossings * ratio) + 1) | 1);
+  if (taps >= kRingSize) taps = (kRingSize - 1);
+  fir = new int16_t[(kPhases * taps)];
+
+  const double fc = (0.5 / ratio); /* Cutoff at nyquist, in cycles */
+  const double half = (taps / 2.0);
+  for (int p = 0; p < kPhases; p++) {
+    for (int i = 0; i < taps; i++) {
+      double x = ((i - ((taps - 1) / 2.0)) - ((double)p / kPhases));
+      double wt = (x / half);
+      double w = ((wt * wt) < 1.0 ? (bessel_i0(beta * sqrt(1.0 - (wt * wt))) / i0beta) : 0.0);
+      double y = (2.0 * fc * x);
+      double sinc = (fabs(y) < 1e-9 ? 1.0 : (sin(M_PI * y) / (M_PI * y)));
+      fir[((p * taps) + i)] = (int16_t)lrint(32768.0 * 2.0 * fc * sinc * w);
+    }
+  }
+  memset(ring, 0, sizeof(ring));
+  step = (uint_fast32_t)((ratio * 65536.0) + 0.5);
+  MOSDBG("[SIDENGINE] Resampler %.0f > %.0fHz, %d taps\n", clockspeed, samplerate, taps);
+  return;
+}
+
+/**
+ * @brief Destroy the sidresampler::sidresampler object
+ *
+ */
+sidresampler::~sidresampler(void)
+{
+  delete[] fir;
+  return;
+}
+
+/**
+ * @brief Filter the most recent input at the current phase
+ *
+ * @return int16_t
+ */
+int16_t sidresampler::output(void)
+{
+  const int16_t *coef = &fir[((int)((frac * kPhases) >> 16) * taps)];
+  const int16_t *in = &ring[(ring_pos + kRingSize - taps)];
+  int32_t sum = 0;
+  for (int i = 0; i < taps; i++) {
+    sum += ((int32_t)coef[i] * in[i]);
+  }
+  sum >>= 15;
+  return (int16_t)(sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum);
+}
@@ -0,0 +1,157 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid and emudore/adorable
+ *
+ * sidengine.h
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _SIDENGINE_H
+#define _SIDENGINE_H
+
+#include <cstdint>
+
+#include <c64util.h>
+
+
+/**
+ * @brief Software MOS6581/8580 for offline rendering
+ *
+ * Three voices with accumulator, sync, ring modulation, noise LFSR
+ * and ADSR envelope, a state variable filter and the external RC
+ * filter of the C64 board, modelled after reSID. Combined waveforms
+ * are the AND of their parts and the 6581 filter curve is a fitted
+ * approximation, close enough for previews and regression audio.
+ *
+ * clock() runs the chip for a batch of cycles and adds one sample
+ * per cycle to the mix buffer, scaled so a single chip at full
+ * volume spans the 16 bit range.
+ */
+class sidengine
+{
+  public:
+    sidengine(void);
+    ~sidengine(void);
+
+    void set_model(bool mos8580);
+    void set_clock_rate(long clockspeed);
+    void reset(void);
+    void write(uint8_t reg, uint8_t data);
+    void clock(uint_fast32_t cycles, int32_t *mix);
+
+  private:
+    typedef enum { kAttack, kDecaySustain, kRelease } env_state_t;
+
+    typedef struct voice_t {
+      /* Oscillator */
+      uint32_t acc;
+      uint32_t freq;
+      uint32_t pw;
+      uint32_t noise;
+      uint8_t control;
+      bool msb_rising;
+      /* Envelope */
+      env_state_t state;
+      uint8_t attack_decay;
+      uint8_t sustain_release;
+      uint8_t env;
+      uint16_t rate_counter;
+      uint16_t rate_period;
+      uint8_t exp_counter;
+      uint8_t exp_period;
+      bool hold_zero;
+    } voice_t;
+
+    voice_t voice[3];
+    uint16_t fc = 0;
+    uint8_t res_filt = 0;
+    uint8_t mode_vol = 0;
+
+    bool is8580 = false;
+    double cycles_per_sec = 985248.0;
+    /* Filter state and coefficients */
+    float vhp = 0, vbp = 0, vlp = 0;
+    float w0 = 0, div_q = 0;
+    /* External filter */
+    float ext_lp = 0, ext_hp = 0;
+    float ext_w0lp = 0, ext_w0hp = 0;
+    /* Model constants */
+    int32_t wave_zero = 0;
+    float voice_dc = 0, mixer_dc = 0;
+
+    void set_cutoff(void);
+    void set_gate(voice_t &v, bool gate);
+    inline uint_fast16_t waveform(const voice_t &v, const voice_t &ring_source);
+    inline void clock_envelope(voice_t &v);
+};
+
+/**
+ * @brief Polyphase FIR resampler from the SID clock to the output rate
+ *
+ * Kaiser windowed sinc with the passband up to 0.45 of the output
+ * rate and ~96dB stopband. Every output sample picks the phase
+ * closest to its fractional input position, the dot product runs
+ * over int16_t so it vectorizes.
+ */
+class sidresampler
+{
+  public:
+    sidresampler(double clockspeed, double samplerate);
+    ~sidresampler(void);
+
+    /* Push one input sample, returns true and sets out when an output
+     * sample is due */
+    inline bool input(int32_t sample, int16_t &out)
+    {
+      int16_t s = (int16_t)(sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample);
+      ring[ring_pos] = ring[ring_pos + kRingSize] = s;
+      ring_pos = ((ring_pos + 1) & (kRingSize - 1));
+      if (--countdown > 0) return false;
+      out = output();
+      uint_fast32_t next = (frac + step);
+      countdown = (int_fast32_t)(next >> 16);
+      frac = (next & 0xffff);
+      return true;
+    };
+
+  private:
+    static const int kPhases = 512;
+    static const int kRingSize = 4096; /* power of two, >= taps */
+
+    int taps;
+    int16_t *fir;              /* [kPhases][taps] */
+    int16_t ring[kRingSize * 2]; /* duplicated so reads never wrap */
+    int ring_pos = 0;
+    uint_fast32_t step;        /* input samples per output, 16.16 */
+    uint_fast32_t frac = 0;
+    int_fast32_t countdown = 1;
+
+    int16_t output(void);
+};
+
+
+#endif /* _SIDENGINE_H */
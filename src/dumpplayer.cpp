@@ -0,0 +1,257 @@
+/*
+ * USBSID-Player aims to be a command line SID file player that is also
+ * suited for embedding where both implementations target use
+ * with USBSID-Pico. USBSID-Pico is a RPi Pico/PicoW (RP2040) &
+ * Pico2/Pico2W (RP2350) based board for interfacing one or two
+ * MOS SID chips and/or hardware SID emulators over (WEB)USB with
+ * your computer, phone or ASID supporting player
+ *
+ * Parts if this emulator are based on other great emulators and players
+ * like Vice, SidplayFp, Websid, SidBerry and emudore/adorable
+ *
+ * dumpplayer.cpp
+ * This file is part of USBSID-Player (https://github.com/LouDnl/USBSID-Player)
+ * File author: LouD
+ *
+ * Copyright (c) 2025-2026 LouD
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <c64util.h>
+#include <sidbackend.h>
+#include <siddump.h>
+
+/* External emulator functions */
+extern sidbackend *emu_sid_output(void);
+
+/* External emulator variables */
+extern volatile sig_atomic_t stop;
+extern volatile sig_atomic_t paused;
+extern int run_seconds;
+
+
+/* Dump file contents, mapped or read into memory on Windows */
+typedef struct dump_map_t {
+  const uint8_t *data;
+  size_t size;
+} dump_map_t;
+
+static bool dump_open(const char *path, dump_map_t &map)
+{
+#if !defined(_WIN32)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < kSidDumpHeaderSize) {
+    close(fd);
+    return false;
+  }
+  void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) return false;
+  madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+  map.data = (const uint8_t *)p;
+  map.size = (size_t)st.st_size;
+#else
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) return false;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *p = (size >= kSidDumpHeaderSize ? (uint8_t *)malloc(size) : NULL);
+  if (p == NULL || fread(p, 1, size, f) != (size_t)size) {
+    free(p);
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  map.data = p;
+  map.size = (size_t)size;
+#endif
+  return true;
+}
+
+static void dump_close(dump_map_t &map)
+{
+#if !defined(_WIN32)
+  munmap((void *)map.data, map.size);
+#else
+  free((void *)map.data);
+#endif
+  map.data = NULL;
+  map.size = 0;
+  return;
+}
+
+/**
+ * @brief Hand cycles above $ffff to the output as waits
+ *
+ * @return uint16_t the cycles that are left
+ */
+static uint16_t dump_wait(sidbackend *out, uint64_t cycles)
+{
+  while (cycles > 0xFFFF) {
+    out->wait(0xFFFF);
+    cycles -= 0xFFFF;
+  }
+  return (uint16_t)cycles;
+}
+
+/* Host time at which played cycles are due */
+static std::chrono::steady_clock::duration dump_time(uint64_t played, long clock)
+{
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>((double)played / (double)clock));
+}
+
+/**
+ * @brief Find the last keyframe at or before target_cycle
+ *
+ * @return pointer to the keyframe record or NULL if there is none
+ */
+static const uint8_t *dump_find_keyframe(const uint8_t *p, const uint8_t *end, uint64_t target_cycle)
+{
+  const uint8_t *found = NULL;
+  while (p < end) {
+    const uint8_t *record = p;
+    uint64_t v = siddump_get_varint(&p, end);
+    if (!(v & 1)) { p += 2; continue; }
+    if (p >= end) break;
+    uint8_t type = *p++;
+    if (type == kSidDumpKeyframe) {
+      uint64_t cycle = siddump_get_varint(&p, end);
+      if (cycle > target_cycle || p >= end) break;
+      found = record;
+      p += (1 + (*p * 0x20));
+    } else if (type == kSidDumpClock) {
+      siddump_get_varint(&p, end);
+    } else {
+      break;
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Play a cycle stamped SID dump on the SID output without
+ * emulating the C64
+ *
+ * @param path dump written with -out dump:<path>
+ * @param start_seconds start at the last keyframe before this time
+ * @return true if the file was a valid dump
+ */
+bool play_sid_dump(const char *path, int start_seconds)
+{
+  sidbackend *out = emu_sid_output();
+  dump_map_t map;
+  if (out == nullptr || !dump_open(path, map)) {
+    MOSDBG("[DUMP] ERROR! Cannot open %s\n", path);
+    return false;
+  }
+  const uint8_t *p = map.data;
+  const uint8_t *end = (map.data + map.size);
+  if (memcmp(p, kSidDumpMagic, sizeof(kSidDumpMagic)) || p[4] != kSidDumpVersion) {
+    MOSDBG("[DUMP] ERROR! %s is not a version %d SID dump\n", path, kSidDumpVersion);
+    dump_close(map);
+    return false;
+  }
+  long clock = (long)siddump_get_u32(&p[8]);
+  int numsids = MIN((int)p[5], kSidDumpMaxSids);
+  uint16_t bases[kSidDumpMaxSids];
+  for (int i = 0; i < numsids; i++) bases[i] = (p[(16 + (i * 2))] | (p[(17 + (i * 2))] << 8));
+  MOSDBG("[DUMP] %s: %d SID(s) @ %ldHz, %zu bytes\n", path, numsids, clock, map.size);
+  out->set_layout(numsids, bases);
+  out->set_clock_rate(clock);
+  p += kSidDumpHeaderSize;
+
+  uint64_t cycle = 0;
+  if (start_seconds > 0) {
+    const uint8_t *key = dump_find_keyframe(p, end, ((uint64_t)start_seconds * clock));
+    if (key != NULL) {
+      /* Skip its delta, restore the registers and continue from there */
+      p = key;
+      siddump_get_varint(&p, end);
+      p++;
+      cycle = siddump_get_varint(&p, end);
+      int chips = *p++;
+      for (int r = 0; r < (chips * 0x20) && p < end; r++, p++) {
+        out->write((uint8_t)r, *p, 0);
+      }
+      MOSDBG("[DUMP] Starting at keyframe @ %llu cycles\n", (unsigned long long)cycle);
+    }
+  }
+
+  const bool realtime = out->realtime();
+  const uint64_t frame_cycles = (uint64_t)(clock / 50);
+  const uint64_t stop_cycle = (run_seconds > 0 ? (cycle + ((uint64_t)run_seconds * clock)) : UINT64_MAX);
+  uint64_t played = 0, last_flush = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  while (p < end && !stop && cycle < stop_cycle) {
+    uint64_t v = siddump_get_varint(&p, end);
+    uint64_t delta = (v >> 1);
+    if (!(v & 1)) {
+      if ((end - p) < 2) break;
+      out->write(p[0], p[1], dump_wait(out, delta));
+      p += 2;
+    } else {
+      uint16_t rest = dump_wait(out, delta);
+      if (rest) out->wait(rest);
+      if (p >= end) break;
+      uint8_t type = *p++;
+      if (type == kSidDumpKeyframe) {
+        siddump_get_varint(&p, end);
+        if (p < end) p += (1 + (*p * 0x20));
+      } else if (type == kSidDumpClock) {
+        clock = (long)siddump_get_varint(&p, end);
+        out->set_clock_rate(clock);
+      } else {
+        break; /* kSidDumpEnd */
+      }
+    }
+    cycle += delta;
+    played += delta;
+    if ((played - last_flush) >= frame_cycles) {
+      out->flush(0);
+      last_flush = played;
+      if (realtime) {
+        std::this_thread::sleep_until(start + dump_time(played, clock));
+      }
+    }
+    while (paused && !stop) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      start = (std::chrono::steady_clock::now() - dump_time(played, clock));
+    }
+  }
+  out->flush(0);
+  MOSDBG("[DUMP] Played %llu cycles\n", (unsigned long long)played);
+  dump_close(map);
+  return true;
+}
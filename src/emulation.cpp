@@ -40,6 +40,9 @@
 #include <ios>
 #endif
 #include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
 #include <functional>
 
 #include <signal.h>
@@ -56,10 +59,7 @@ USBSID_NS::USBSID_Class* usbsid;
 #elif EMBEDDED
 #include <config.h>
 extern "C" {
-void reset_sid(void);
-void reset_sid_registers(void);
 int return_clockrate(void);
-void apply_clockrate(int n_clock, bool suspend_sids);
 extern Config usbsid_config;
 extern RuntimeCFG cfg;
 }
@@ -68,8 +68,36 @@ extern RuntimeCFG cfg;
 /* VSIDPSID external functions */
 extern void next_prev_tune(bool next);
 
-/* Pre declarations */
-void emulate_c64_single(void);
+/* SID output backend, created by hardwaresid_init */
+static sidbackend *sidout = nullptr;
+#if DESKTOP
+/* SIDs on the connected board, the layout is limited to these */
+static int usbsid_numsids = 0;
+#endif
+void hardwaresid_deinit(void);
+
+/* Set by emu_init when any read/write logging is enabled */
+static bool trace_bus = false;
+
+/* Timed command queue, filled by the input side and emptied by the
+ * run loop. Queued commands get their due cycle when the run loop
+ * picks them up and are applied from the CMD alarm */
+#define CMD_QUEUE_SIZE 32 /* power of two */
+static emu_cmd_t cmd_queue[CMD_QUEUE_SIZE];
+static std::atomic<uint32_t> cmd_head{0}; /* written by the run loop */
+static std::atomic<uint32_t> cmd_tail{0}; /* written by the producer */
+typedef struct pending_cmd_t {
+  CPUCLOCK clk;
+  emu_cmd_t cmd;
+} pending_cmd_t;
+static pending_cmd_t cmd_pending[CMD_QUEUE_SIZE];
+static int cmd_num_pending = 0;
+static alarm_t cmd_alarm = -1;
+
+/* Ends the run after run_seconds, armed once the tune clock is known */
+static alarm_t stop_alarm = -1;
+/* Set when the stop came from run_seconds and not from the user */
+static bool run_expired = false;
 
 
 #if DESKTOP
@@ -127,14 +155,7 @@ void getinfo_USBSID(int clockspeed)
   fmoplsidno = usbsid->USBSID_GetFMOplSID();
   pcbversion = usbsid->USBSID_GetPCBVersion();
 #elif EMBEDDED
-  int clockrates[] = { 1000000, 985248, 1022727, 1023440, 1022730 };
-  if(usbsid_config.clock_rate != clockspeed) {
-    for (int i = 0; i < count_of(clockrates); i++) {
-      if (clockrates[i] == clockspeed) {
-        apply_clockrate(i, true);
-      }
-    }
-  }
+  if (sidout) sidout->set_clock_rate(clockspeed);
 
   if(cfg.numsids < sidcount) {
     MOSDBG("[WARNING] Tune no.sids %d is higher then USBSID-Pico no.sids %d forcing max sidcount to %d\n", sidcount, cfg.numsids, cfg.numsids);
@@ -162,37 +183,60 @@ void getinfo_USBSID(int clockspeed)
 void hardwaresid_init(void)
 {
   MOSDBG("[HARDWARESID] Init\n");
+  if (sidout) hardwaresid_deinit();
 #if DESKTOP
-  if (!setup_USBSID()) { usbsid = nullptr; }
-  if (usbsid) {
-    usbsid->USBSID_ResetAllRegisters();
-    usbsid->USBSID_Reset();
+  usbsid = nullptr;
+  if (!strcmp(sid_output, "usbsid")) {
+    if (setup_USBSID()) {
+      sidout = new sidbackend_usbsid(usbsid);
+      /* One board only, SIDs 5 to 8 are for the software backends */
+      usbsid_numsids = usbsid->USBSID_GetNumSIDs();
+      MOSDBG("[HARDWARESID] %d SID(s) available\n", usbsid_numsids);
+    } else {
+      usbsid = nullptr;
+    }
+  } else if (!strncmp(sid_output, "file:", 5)) {
+    sidout = sidbackend_file::open(sid_output + 5);
+  } else if (!strncmp(sid_output, "wav:", 4)) {
+    sidout = sidbackend_wav::open(sid_output + 4, render_rate, render_8580);
+  } else if (!strncmp(sid_output, "dump:", 5)) {
+    sidout = sidbackend_dump::open(sid_output + 5);
+  } else if (strcmp(sid_output, "null")) {
+    MOSDBG("[HARDWARESID] Unknown SID output %s\n", sid_output);
+  }
+  if (sidout && sidout->realtime() && lookahead_frames > 0) {
+    sidout = new sidbackend_ring(sidout, lookahead_frames);
   }
 #elif EMBEDDED
-  reset_sid();
-  emu_sleep_us(100);
-  reset_sid_registers();
-  emu_sleep_us(100);
+  sidout = new sidbackend_usbsid();
 #endif
+  if (!sidout) {
+    sidout = new sidbackend_null();
+  }
+  MOSDBG("[HARDWARESID] Output: %s\n", sidout->name());
+  sidout->reset();
+  if (SID) SID->out = sidout;
+  if (Vic) Vic->realtime = sidout->realtime();
   return;
 }
 
 void hardwaresid_deinit(void)
 {
   MOSDBG("[HARDWARESID] Deinit\n");
+  if (SID) SID->out = nullptr;
+  if (sidout) {
+    /* Queued output still plays unless the user stopped the tune */
+    if (stop && !run_expired) sidout->abort();
+    sidout->close();
+    delete sidout;
+    sidout = nullptr;
+  }
 #if DESKTOP
   if (usbsid) {
-    usbsid->USBSID_Flush();
-    usbsid->USBSID_DisableThread();
-    usbsid->USBSID_ResetAllRegisters();
-    usbsid->USBSID_Reset();
     delete usbsid;
+    usbsid = nullptr;
   }
-#elif EMBEDDED
-  reset_sid_registers();
-  emu_sleep_us(100);
-  reset_sid();
-  emu_sleep_us(100);
+  usbsid_numsids = 0;
 #endif
 
   return;
@@ -217,6 +261,144 @@ void log_logs(void)
   );
 }
 
+/**
+ * @brief Queue a group of timed commands for the emulator
+ *
+ * Safe to call from another thread than the one running the
+ * machine. The group is published at once, each command is
+ * applied delay cycles after the run loop picks the group up
+ *
+ * @param cmds
+ * @param n_cmds
+ * @return true if queued, false if the queue is full
+ */
+bool emu_queue_commands(const emu_cmd_t *cmds, int n_cmds)
+{
+  uint32_t tail = cmd_tail.load(std::memory_order_relaxed);
+  uint32_t head = cmd_head.load(std::memory_order_acquire);
+  if ((tail - head + (uint32_t)n_cmds) > CMD_QUEUE_SIZE) {
+    MOSDBG("[EMU] Command queue full, dropping %d commands\n", n_cmds);
+    return false;
+  }
+  for (int i = 0; i < n_cmds; i++) {
+    cmd_queue[(tail + i) & (CMD_QUEUE_SIZE - 1)] = cmds[i];
+  }
+  cmd_tail.store((tail + n_cmds), std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Apply every pending command due at cycle now and set the
+ * CMD alarm for the next one
+ *
+ * @param now
+ */
+static void emu_apply_commands(CPUCLOCK now)
+{
+  int applied = 0;
+  while (applied < cmd_num_pending && cmd_pending[applied].clk <= now) {
+    const emu_cmd_t &c = cmd_pending[applied++].cmd;
+    switch (c.kind) {
+      case kCmdKeyDown:
+        Cia1->write_prab_bits(c.a, c.b, true);
+        break;
+      case kCmdKeyUp:
+        Cia1->write_prab_bits(c.a, c.b, false);
+        break;
+      case kCmdSetPC:
+        Cpu->pc(c.addr);
+        break;
+      case kCmdHotReset:
+        Cpu->hot_reset();
+        break;
+      case kCmdWriteRam:
+        MMU->dma_write_ram(c.addr, c.a);
+        break;
+    }
+  }
+  cmd_num_pending -= applied;
+  for (int i = 0; i < cmd_num_pending; i++) {
+    cmd_pending[i] = cmd_pending[i + applied];
+  }
+  if (cmd_num_pending > 0) {
+    Cpu->alarms.set(cmd_alarm, cmd_pending[0].clk);
+  } else {
+    Cpu->alarms.unset(cmd_alarm);
+  }
+  return;
+}
+
+static void emu_command_alarm(void *context, CPUCLOCK clk)
+{
+  (void)context;
+  emu_apply_commands(clk);
+  return;
+}
+
+/**
+ * @brief Move queued commands to the pending list with their due
+ * cycle, commands without delay are applied right away
+ *
+ */
+static void emu_take_commands(void)
+{
+  CPUCLOCK now = Cpu->cycles();
+  uint32_t head = cmd_head.load(std::memory_order_relaxed);
+  uint32_t tail = cmd_tail.load(std::memory_order_acquire);
+  for (; head != tail; head++) {
+    const emu_cmd_t &c = cmd_queue[head & (CMD_QUEUE_SIZE - 1)];
+    if _MOS_UNLIKELY (cmd_num_pending >= CMD_QUEUE_SIZE) {
+      MOSDBG("[EMU] Too many pending commands, dropping command %d\n", c.kind);
+      continue;
+    }
+    /* Keep the list sorted, equal cycles apply in queue order */
+    CPUCLOCK clk = (now + c.delay);
+    int i = cmd_num_pending++;
+    for (; i > 0 && cmd_pending[i - 1].clk > clk; i--) {
+      cmd_pending[i] = cmd_pending[i - 1];
+    }
+    cmd_pending[i] = { clk, c };
+  }
+  cmd_head.store(head, std::memory_order_release);
+  emu_apply_commands(now);
+  return;
+}
+
+static inline bool emu_commands_queued(void)
+{
+  return (cmd_head.load(std::memory_order_relaxed)
+    != cmd_tail.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Clear the command queue, pending commands are dropped
+ *
+ */
+static void emu_reset_commands(void)
+{
+  cmd_head.store(0, std::memory_order_relaxed);
+  cmd_tail.store(0, std::memory_order_relaxed);
+  cmd_num_pending = 0;
+  cmd_alarm = -1;
+  return;
+}
+
+/**
+ * @brief Press a key for one frame of emulated time
+ *
+ * @param row
+ * @param col
+ */
+static void emu_press_key(uint8_t row, uint8_t col)
+{
+  const emu_cmd_t press[] = {
+    { kCmdKeyDown, 0, 0, row, col },
+    { kCmdKeyUp, (CPUCLOCK)Vic->refresh_rate, 0, row, col },
+  };
+  emu_queue_commands(press, count_of(press));
+  return;
+}
+
 /**
  * @brief Send keyboard command to emulator for pause
  */
@@ -224,15 +406,10 @@ void emu_pause_playing(bool pause)
 {
   if (vsidpsid) {
     paused = pause;
-#if DESKTOP
-    if (paused) usbsid->USBSID_Mute();
-    else usbsid->USBSID_UnMute();
-#endif
+    if (sidout) sidout->mute(paused);
   } else {
     /* This is actually not a pause but a stop command */
-    Cia1->write_prab_bits(row_bit_runstop,col_bit_runstop,true);
-    emu_sleep_us((uint64_t)Vic->refresh_rate);
-    Cia1->write_prab_bits(row_bit_runstop,col_bit_runstop,false);
+    emu_press_key(row_bit_runstop,col_bit_runstop);
   }
   return;
 }
@@ -248,16 +425,7 @@ void emu_next_subtune(void)
     next_prev_tune(true);
   } else {
     MOSDBG("[EMU] Next tune PRG\n");
-    Cia1->write_prab_bits(row_bit_plus,col_bit_plus,true);
-#if DESKTOP /* On DESKTOP we can just do a simple refresh rate long sleep */
-    emu_sleep_us((uint64_t)Vic->refresh_rate);
-#elif EMBEDDED /* On EMBEDDED we need the emulator to finish the current frame instead of sleeping */
-    uint64_t start_cycles = Cpu->cycles();
-    while (Cpu->cycles() - start_cycles < (uint64_t)Vic->refresh_rate) {
-        emulate_c64_single();
-    }
-#endif
-    Cia1->write_prab_bits(row_bit_plus,col_bit_plus,false);
+    emu_press_key(row_bit_plus,col_bit_plus);
   }
   return;
 }
@@ -273,16 +441,7 @@ void emu_previous_subtune(void)
     next_prev_tune(false);
   } else {
     MOSDBG("[EMU] Previous tune PRG\n");
-    Cia1->write_prab_bits(row_bit_minus,col_bit_minus,true);
-#if DESKTOP /* On DESKTOP we can just do a simple refresh rate long sleep */
-    emu_sleep_us((uint64_t)Vic->refresh_rate);
-#elif EMBEDDED /* On EMBEDDED we need the emulator to finish the current frame instead of sleeping */
-    uint64_t start_cycles = Cpu->cycles();
-    while (Cpu->cycles() - start_cycles < (uint64_t)Vic->refresh_rate) {
-        emulate_c64_single();
-    }
-#endif
-    Cia1->write_prab_bits(row_bit_minus,col_bit_minus,false);
+    emu_press_key(row_bit_minus,col_bit_minus);
   }
   return;
 }
@@ -311,6 +470,140 @@ void emu_dma_write_ram(uint16_t address, uint8_t data)
   return ;
 }
 
+/**
+ * @brief Wrapper around MMU->dma_read_block()
+ *
+ * @param address
+ * @param data
+ * @param len
+ */
+void emu_dma_read_block(uint16_t address, uint8_t *data, size_t len)
+{
+  MMU->dma_read_block(address,data,len);
+  return;
+}
+
+/**
+ * @brief Wrapper around MMU->dma_write_block()
+ *
+ * @param address
+ * @param data
+ * @param len
+ */
+void emu_dma_write_block(uint16_t address, const uint8_t *data, size_t len)
+{
+  MMU->dma_write_block(address,data,len);
+  return;
+}
+
+/**
+ * @brief Wrapper around MMU->dma_fill()
+ *
+ * @param address
+ * @param value
+ * @param len
+ */
+void emu_dma_fill(uint16_t address, uint8_t value, size_t len)
+{
+  MMU->dma_fill(address,value,len);
+  return;
+}
+
+/**
+ * @brief Replace the SID layout of the tune with sid_layout,
+ * e.g. "d400,d420,de00,df00", addresses within $d400/$d7ff
+ * or $de00/$dfff
+ *
+ */
+static void emu_override_sid_layout(void)
+{
+  uint16_t *sids[mos6581_8580::kMaxSids] = {
+    &SID->sidone, &SID->sidtwo, &SID->sidthree, &SID->sidfour,
+    &SID->sidfive, &SID->sidsix, &SID->sidseven, &SID->sideight
+  };
+  uint16_t bases[mos6581_8580::kMaxSids] = { 0 };
+  const char *p = sid_layout;
+  int count = 0;
+  while (*p && count < mos6581_8580::kMaxSids) {
+    char *end;
+    unsigned long addr = strtoul(p, &end, 16);
+    if (end == p || addr < 0xD400 || addr > 0xDFE0
+       || (addr >= 0xD800 && addr < 0xDE00)) break; /* Not routed to the SID */
+    bases[count++] = (uint16_t)(addr & 0xFFE0);
+    p = (*end == ',' ? (end + 1) : end);
+  }
+  if (count == 0 || *p) {
+    MOSDBG("[SID] Invalid SID layout %s\n", sid_layout);
+    return;
+  }
+  for (int i = 0; i < mos6581_8580::kMaxSids; i++) {
+    *sids[i] = bases[i];
+  }
+  SID->sidcount = count;
+  return;
+}
+
+/**
+ * @brief Wrapper around MMU->map_io(), call after changing
+ * the SID layout
+ *
+ */
+void emu_map_io(void)
+{
+  if (sid_layout) emu_override_sid_layout();
+#if DESKTOP
+  if (usbsid && usbsid_numsids > 0 && SID->sidcount > usbsid_numsids) {
+    MOSDBG("[WARNING] Tune uses %d SIDs, USBSID-Pico has %d, limiting to %d\n",
+      SID->sidcount, usbsid_numsids, usbsid_numsids);
+    SID->sidcount = usbsid_numsids;
+  }
+#endif
+  SID->map_sids();
+  MMU->map_io();
+  if (sidout) {
+    uint16_t bases[mos6581_8580::kMaxSids];
+    int numsids = SID->sid_bases(bases);
+    sidout->set_layout(numsids, bases);
+  }
+  return;
+}
+
+/**
+ * @brief The SID output backend, for players that bypass the emulator
+ *
+ * @return sidbackend* or nullptr before hardwaresid_init
+ */
+sidbackend *emu_sid_output(void)
+{
+  return sidout;
+}
+
+static void emu_stop_alarm(void *context, CPUCLOCK clk)
+{
+  (void)context;
+  (void)clk;
+  MOSDBG("[EMU] Ran for %d seconds, stopping\n", run_seconds);
+  run_expired = true;
+  stop = true;
+  return;
+}
+
+/**
+ * @brief Set the clock rate of the SID output, also starts the
+ * run_seconds countdown
+ *
+ * @param clockspeed in Hz
+ */
+void emu_sid_clock_rate(long clockspeed)
+{
+  if (sidout) sidout->set_clock_rate(clockspeed);
+  if (run_seconds > 0) {
+    run_expired = false;
+    Cpu->alarms.set(stop_alarm, (Cpu->cycles() + ((CPUCLOCK)run_seconds * clockspeed)));
+  }
+  return;
+}
+
 /**
  * @brief Wrapper around MMU->read_byte()
  *
@@ -319,7 +612,7 @@ void emu_dma_write_ram(uint16_t address, uint8_t data)
  */
 uint8_t emu_read_byte(uint16_t address)
 {
-  return MMU->read_byte(address);
+  return (trace_bus ? MMU->read_byte<trace_on>(address) : MMU->read_byte(address));
 }
 
 /**
@@ -330,7 +623,29 @@ uint8_t emu_read_byte(uint16_t address)
  */
 void emu_write_byte(uint16_t address, uint8_t data)
 {
-  MMU->write_byte(address, data);
+  if (trace_bus) MMU->write_byte<trace_on>(address, data);
+  else MMU->write_byte(address, data);
+  return;
+}
+
+/**
+ * @brief Cpu bus wrappers around MMU->read_byte() and
+ * MMU->write_byte(), emu_init only hooks up the traced
+ * instantiation when read/write logging is enabled
+ *
+ * @param address
+ * @return uint8_t
+ */
+template<class Trace>
+static uint8_t emu_bus_read(uint16_t address)
+{
+  return MMU->read_byte<Trace>(address);
+}
+
+template<class Trace>
+static void emu_bus_write(uint16_t address, uint8_t data)
+{
+  MMU->write_byte<Trace>(address, data);
   return;
 }
 
@@ -391,8 +706,15 @@ void emu_init(void)
   reset_player_state();
 #endif
 
+  trace_bus = (log_readwrites || log_romrw || log_vicrw || log_vicrrw
+    || log_cia1rw || log_cia2rw || log_sidrw || heatmap_file);
+
   MMU = new mmu();
-  Cpu = new mos6510(emu_read_byte, emu_write_byte);
+  if (trace_bus) {
+    Cpu = new mos6510(emu_bus_read<trace_on>, emu_bus_write<trace_on>);
+  } else {
+    Cpu = new mos6510(emu_bus_read<trace_off>, emu_bus_write<trace_off>);
+  }
   Pla = new mos906114(MMU);
   Vic = new mos6560_6561();
   Cia1 = new mos6526(CIA1_ADDRESS);
@@ -404,9 +726,15 @@ void emu_init(void)
   Pla->glue_c64(Cpu);
   Cpu->glue_c64(MMU,Vic,Cia1,Cia2);
   MMU->glue_c64(Cpu,Pla,Vic,Cia1,Cia2,SID);
+  SID->glue_c64(MMU,Cpu);
+  emu_reset_commands();
+  cmd_alarm = Cpu->alarms.add("CMD", emu_command_alarm, nullptr);
+  stop_alarm = Cpu->alarms.add("STOP", emu_stop_alarm, nullptr);
   MOSDBG("[C64] glued\n");
 
-  mos6510::loginstructions = log_instructions;
+  Cpu->direct_ram(!trace_bus); /* Log zero page and stack accesses too */
+  Cpu->loginstructions = log_instructions;
+  Cpu->superblocks_enabled = use_superblocks;
 
   MMU->log_pla = log_pla;
   MMU->log_readwrites = log_readwrites;
@@ -418,10 +746,29 @@ void emu_init(void)
 
   SID->log_sidrw = log_sidrw;
 
+  if (heatmap_file) {
+    MMU->heat = new heatmap();
+    /* Count every instruction */
+    Cpu->superblocks_enabled = false;
+    Cpu->idle_skip_enabled = false;
+  }
+
   playing = true;
   return;
 }
 
+/**
+ * @brief Write the access heat map to heatmap_file
+ *
+ */
+void emu_heatmap_dump(void)
+{
+  if (MMU && MMU->heat && heatmap_file) {
+    MMU->heat->dump(heatmap_file);
+  }
+  return;
+}
+
 /**
  * @brief Emulator deinit
  *
@@ -431,12 +778,20 @@ void emu_deinit(void)
   MOSDBG("[C64] Deinit\n");
   stop = true; /* Make sure we're stopped if not already */
 
+  if (MMU->heat) {
+    emu_heatmap_dump();
+    delete MMU->heat;
+    MMU->heat = nullptr;
+  }
+
   /* Required or the player will not restart when embedding */
   Pla->reset();
   Cia1->reset();
   Cia2->reset();
   Vic->reset();
   Cpu->reset();
+  emu_reset_commands();
+  stop_alarm = -1;
 
   /* Delete all objects */
   delete SID;
@@ -465,78 +820,260 @@ void cycle_callback(mos6510* cpu)
   return;
 }
 
-void emulate_c64_upto(uint_least16_t pc)
+/**
+ * @brief Emulate one cpu instruction, then run the peripherals
+ * whose alarm is due
+ *
+ * Trace selects the instantiation, the trace_off one carries no
+ * log checks at all. Superblocks are only used when the caller
+ * does not need to stop at a single instruction and never traced
+ */
+template<class Trace, bool Blocks>
+static _MOS_INLINE void emulate_c64_step(void)
 {
-  while (!stop) {
-    if (Cpu->pc() == pc) break;
-    Cpu->emulate();
-    Vic->emulate();
-    Cia1->emulate();
-    Cia2->emulate();
+  if (Trace::enabled && MMU->heat) MMU->heat->exec(Cpu->pc());
+  if (Trace::enabled && Cpu->loginstructions) {
+    Cpu->step<trace_on>();
+  } else if (Blocks && Cpu->superblocks_enabled) {
+    Cpu->emulate_block();
+  } else {
+    Cpu->step<trace_off>();
+  }
+  if _MOS_UNLIKELY (Cpu->alarms.due(Cpu->cycles())) {
+    Cpu->alarms.dispatch(Cpu->cycles());
   }
-  MOSDBG("[CPU] PC $%04x reached!\n",pc);
+}
 
-  return;
+/* Cycles run between checks for a stop or pause request */
+#define RUN_BATCH_CYCLES 256
+
+/**
+ * @brief Machine run loop behind run_until
+ *
+ * Runs batches of instructions up to target_cycle, Checks is set
+ * when a pc or opcode stop condition has to be tested after every
+ * instruction, without it superblocks can be used
+ */
+template<class Trace, bool Checks>
+static run_result_t run_until_(CPUCLOCK target_cycle, const run_stop_t &conditions)
+{
+  while (Cpu->cycles() < target_cycle) {
+    if _MOS_UNLIKELY (stop) { return kRunStop; }
+#if DESKTOP
+    while (paused){}
+#endif
+    if _MOS_UNLIKELY (emu_commands_queued()) { emu_take_commands(); }
+    if (Trace::enabled && heatmap_dump_requested) {
+      heatmap_dump_requested = false;
+      emu_heatmap_dump();
+    }
+    CPUCLOCK batch_end = MIN(target_cycle, (Cpu->cycles() + RUN_BATCH_CYCLES));
+    do {
+      if constexpr (Checks) {
+        if (Cpu->pc() == conditions.pc) { return kRunPC; }
+      }
+      emulate_c64_step<Trace, !Checks>();
+      if constexpr (Checks) {
+        if (Cpu->last_insn == conditions.opcode) { return kRunOpcode; }
+      }
+#if DESKTOP
+      if constexpr (Trace::enabled) {
+        if (log_timers) {
+          Cia1->dump_timers();
+          Cia2->dump_timers();
+          Vic->dump_timers();
+          MOSDBG("\n");
+        }
+      }
+#endif
+    } while (Cpu->cycles() < batch_end);
+  }
+  return kRunBudget;
 }
 
-void emulate_until_opcode(uint_least8_t opcode)
+/**
+ * @brief Run the machine until target_cycle is reached or one of
+ * the stop conditions hits
+ *
+ * The single machine run loop, all emulate_* entry points below
+ * are thin wrappers around it
+ *
+ * @param target_cycle cpu cycle to run up to, RUN_FOREVER for no budget
+ * @param conditions pc and opcode to stop at, -1 to disable either
+ * @return run_result_t the reason it returned
+ */
+run_result_t run_until(CPUCLOCK target_cycle, const run_stop_t &conditions)
 {
-  while (!stop) {
-    Cpu->emulate();
-    Vic->emulate();
-    Cia1->emulate();
-    Cia2->emulate();
-    if (Cpu->last_insn == opcode) { return; }
+  bool checks = (conditions.pc >= 0 || conditions.opcode >= 0);
+  run_result_t result;
+  /* Idle loop skips must not run past the budget */
+  Cpu->idle_limit = target_cycle;
+  if (Cpu->loginstructions || log_timers || MMU->heat) {
+    result = (checks ? run_until_<trace_on, true>(target_cycle, conditions)
+      : run_until_<trace_on, false>(target_cycle, conditions));
+  } else {
+    result = (checks ? run_until_<trace_off, true>(target_cycle, conditions)
+      : run_until_<trace_off, false>(target_cycle, conditions));
   }
+  Cpu->idle_limit = RUN_FOREVER;
+  return result;
+}
 
+void emulate_c64_upto(uint_least16_t pc)
+{
+  if (run_until(RUN_FOREVER, {pc, -1}) == kRunPC) {
+    MOSDBG("[CPU] PC $%04x reached!\n",pc);
+  }
+  return;
+}
+
+void emulate_until_opcode(uint_least8_t opcode)
+{
+  run_until(RUN_FOREVER, {-1, opcode});
   return;
 }
 
 void emulate_until_rti(void)
 {
-  while (!stop) {
-    Cpu->emulate();
-    Vic->emulate();
-    Cia1->emulate();
-    Cia2->emulate();
-    if (Cpu->last_insn == 0x40) { return; }
-  }
+  emulate_until_opcode(0x40);
+  return;
+}
 
+/**
+ * @brief Run the machine for n_cycles
+ *
+ * @param n_cycles
+ */
+void emulate_c64_cycles(CPUCLOCK n_cycles)
+{
+  run_until((Cpu->cycles() + n_cycles), {-1, -1});
   return;
 }
 
 void emulate_c64_single(void)
 {
-  if (!stop) {
-    Cpu->emulate();
-    Vic->emulate();
-    Cia1->emulate();
-    Cia2->emulate();
-  }
+  /* One cycle budget, runs a single instruction or superblock */
+  emulate_c64_cycles(1);
   return;
 }
 
 void emulate_c64(void)
 {
   log_logs();
-  while (!stop) {
-#if DESKTOP
-    while (paused){}
-#endif
-    Cpu->emulate();
-    Vic->emulate();
-    Cia1->emulate();
-    Cia2->emulate();
-#if DESKTOP
-    if __unlikely (log_timers) {
-      Cia1->dump_timers();
-      Cia2->dump_timers();
-      Vic->dump_timers();
-      MOSDBG("\n");
+  run_until(RUN_FOREVER, {-1, -1});
+  return;
+}
+
+/**
+ * @brief Exhaustive decimal mode ADC/SBC test
+ *
+ * Runs ADC # and SBC # for every accumulator, operand and carry
+ * combination with the decimal flag set and compares the result
+ * and the NVZC flags against the previous branching formulas,
+ * copied below. It guards against regressions only, it is not an
+ * independent model of the NMOS chip
+ *
+ * @return unsigned int number of mismatches
+ */
+static unsigned int c64_decimal_test(void)
+{
+  const uint16_t startaddr = 0x400;
+  unsigned int failures = 0;
+
+  for (int sub = 0; sub < 2; sub++) {
+    emu_dma_write_ram(startaddr, (sub ? 0xe9 : 0x69)); /* SBC # / ADC # */
+    for (unsigned int c = 0; c < 2; c++) {
+      for (unsigned int a = 0; a < 0x100; a++) {
+        for (unsigned int v = 0; v < 0x100; v++) {
+          /* previous formulas */
+          uint16_t t;
+          bool carry, overflow;
+          if (!sub) {
+            t = (a & 0xf) + (v & 0xf) + c;
+            if (t > 0x09) t += 0x6;
+            t += (a & 0xf0) + (v & 0xf0);
+            if ((t & 0x1f0) > 0x90) t += 0x60;
+            carry = (t > 0xff);
+            t &= 0xff;
+            overflow = (!((a ^ v) & 0x80) && ((a ^ t) & 0x80));
+          } else {
+            t = (a & 0xf) - (v & 0xf) - (c ? 0 : 1);
+            if ((t & 0x10) != 0) t = ((t - 0x6) & 0xf) | ((a & 0xf0) - (v & 0xf0) - 0x10);
+            else t = (t & 0xf) | ((a & 0xf0) - (v & 0xf0));
+            if ((t & 0x100) != 0) t -= 0x60;
+            carry = (t < 0x100);
+            t &= 0xff;
+            overflow = (((a ^ t) & 0x80) && ((a ^ v) & 0x80));
+          }
+
+          emu_dma_write_ram(startaddr + 1, v);
+          Cpu->pc(startaddr);
+          Cpu->a(a);
+          Cpu->cf(c);
+          Cpu->dmf(true);
+          Cpu->step<trace_off>();
+
+          if (Cpu->a() != t || Cpu->cf() != carry || (bool)Cpu->of() != overflow
+            || (bool)Cpu->zf() != (t == 0) || (bool)Cpu->nf() != ((t & 0x80) != 0)) {
+            if (failures++ < 16) {
+              MOSDBG("[TEST] %s $%02x,$%02x C%u = $%02x C%d V%d, expected $%02x C%d V%d\n",
+                (sub ? "SBC" : "ADC"), a, v, c,
+                Cpu->a(), Cpu->cf(), (bool)Cpu->of(), t, carry, overflow);
+            }
+          }
+        }
+      }
     }
-#endif
   }
-  return;
+  Cpu->dmf(false);
+
+  return failures;
+}
+
+/**
+ * @brief Idle loop budget test
+ *
+ * Parks the cpu in a JMP * loop with interrupts off and runs budgets
+ * from a single cycle up to several frames. Idle skipping must stop
+ * at the budget, so run_until may only pass it by the few cycles of
+ * the loop instruction that crosses it
+ *
+ * @return unsigned int number of budgets overshot
+ */
+static unsigned int c64_idle_budget_test(void)
+{
+  const uint16_t startaddr = 0x400;
+  const CPUCLOCK budgets[] = { 1, 2, 3, 7, 63, 64, 1000, 19656, 20000, 65535, 100000 };
+  unsigned int failures = 0;
+
+  emu_write_byte(pAddrMemoryLayout, 0x35); /* IO in, ROMs out */
+  emu_write_byte(0xdc0d, 0x7f); /* No CIA interrupts */
+  emu_write_byte(0xdd0d, 0x7f);
+  emu_dma_write_ram(startaddr, 0x4c); /* JMP $0400 */
+  emu_dma_write_ram((startaddr + 1), (startaddr & 0xff));
+  emu_dma_write_ram((startaddr + 2), (startaddr >> 8));
+  Cpu->pc(startaddr);
+  Cpu->idf(true);
+  uint64_t skipped = Cpu->idle_skipped_cycles();
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < (int)count_of(budgets); i++) {
+      CPUCLOCK target = (Cpu->cycles() + budgets[i]);
+      run_until(target, {-1, -1});
+      /* JMP takes 3 cycles, it ends at most 2 past the budget */
+      if (Cpu->cycles() > (target + 2)) {
+        if (failures++ < 16) {
+          MOSDBG("[TEST] Budget %llu overshot by %llu cycles\n",
+            (unsigned long long)budgets[i], (unsigned long long)(Cpu->cycles() - target));
+        }
+      }
+    }
+  }
+  MOSDBG("[TEST] Idle loop skipped %llu cycles\n",
+    (unsigned long long)(Cpu->idle_skipped_cycles() - skipped));
+  Cpu->idf(false);
+  emu_write_byte(pAddrMemoryLayout, 0);
+
+  return failures;
 }
 
 void start_c64_test(void) /* Finishes successfully */
@@ -549,10 +1086,17 @@ void start_c64_test(void) /* Finishes successfully */
 
   /* unmap C64 ROMs */
   emu_write_byte(pAddrMemoryLayout, 0);
+  /* decimal mode first, the functional test only covers valid BCD */
+  unsigned int failures = c64_decimal_test();
+  MOSDBG("[TEST] Decimal mode ADC/SBC %s, %u mismatches\n",
+    (failures ? "failed" : "passed"), failures);
+  failures = c64_idle_budget_test();
+  MOSDBG("[TEST] Idle loop budget %s, %u overshoots\n",
+    (failures ? "failed" : "passed"), failures);
   /* load tests into RAM */
   #include <6502_functional_test.h>
-  for(int i = startaddr; i < count_of(functional_6502_test); i++) {
-    emu_dma_write_ram(i,functional_6502_test[(i-startaddr)]);
+  for(int i = 0; i < (int)count_of(functional_6502_test); i++) {
+    emu_dma_write_ram((startaddr+i),functional_6502_test[i]);
   }
   Cpu->pc(0x400); /* Fix address at $400 for binary test*/
 
@@ -45,6 +45,8 @@
 #include <mos6560_6561_vic.h>
 #include <mos906114_pla.h>
 #include <mmu.h>
+#include <heatmap.h>
+#include <sidbackend.h>
 
 /* C64 Variables */
 mos6510 *Cpu;
@@ -77,15 +79,18 @@ volatile sig_atomic_t stop = false;
 volatile sig_atomic_t playing = false;
 volatile sig_atomic_t paused = false;
 volatile sig_atomic_t vsidpsid = false;
+volatile sig_atomic_t heatmap_dump_requested = false;
 #elif EMBEDDED
 volatile bool stop = false;
 volatile bool playing = false;
 volatile bool paused = false;
 volatile bool vsidpsid = false;
+volatile bool heatmap_dump_requested = false;
 #endif
 
 /* Emulation variables */
 bool enable_r2 = false;
+bool use_superblocks = false;
 bool log_instructions = false;
 bool log_timers = false;
 bool log_pla = false;
@@ -96,6 +101,13 @@ bool log_vicrrw = false;
 bool log_cia1rw = false;
 bool log_cia2rw = false;
 bool log_sidrw = false;
+const char * heatmap_file = nullptr; /* Access heat map output, CSV for .csv else binary */
+const char * sid_output = "usbsid"; /* SID output backend: usbsid, null, file:<path>, wav:<path> or dump:<path> */
+int render_rate = 44100; /* Sample rate of the wav output */
+bool render_8580 = false; /* Render 8580 instead of 6581 chips */
+int lookahead_frames = 0; /* Frames the emulation may run ahead of hardware output, 0 is in lockstep */
+int run_seconds = 0; /* Stop after this many seconds of tune time, 0 runs until stopped */
+const char * sid_layout = nullptr; /* Comma separated SID addresses overriding the tune, up to 8 */
 
 
 #endif /* _US_EMULATION_H */
@@ -67,11 +67,14 @@ extern uint8_t emu_read_byte(uint16_t addr);
 extern void emu_write_byte(uint16_t addr, uint8_t data);
 extern uint8_t emu_dma_read_ram(uint16_t address);
 extern uint8_t emu_dma_write_ram(uint16_t address, uint8_t data);
+extern void emu_dma_write_block(uint16_t address, const uint8_t *data, size_t len);
 extern void cycle_callback(mos6510* cpu);
 extern void emulate_c64_upto(uint_least16_t pc);
 extern void emulate_until_opcode(uint_least8_t opcode);
 extern void emulate_until_rti(void);
 extern void emulate_c64(void);
+extern void emu_map_io(void);
+extern void emu_sid_clock_rate(long clockspeed);
 extern void start_c64_test(void);
 extern void log_logs(void);
 
@@ -204,9 +207,7 @@ void copy_sid_to_ram(void)
 
   /* Copy SID data to RAM */
   // MOSDBG("[USPLAYER] RAM@0x%x SID@0x%x SIZE:%u\n", RAM+load_addr,psid_buffer,sid_len);
-  for(int i = load_addr; i < (load_addr+sid_len); i++) {
-    emu_dma_write_ram(i,psid_buffer[(i-load_addr)]);
-  }
+  emu_dma_write_block(load_addr,psid_buffer,sid_len);
 }
 
 /**
@@ -568,6 +569,7 @@ void start_player(void)
   SID->sidfour  = (sidcount >= 2 && sidfour != 0x0000 ? sidtwo : 0x0000);
 
   SID->print_settings();
+  emu_map_io();
 
   Vic->cycles_per_sec = clock_speed;
   Vic->refresh_frequency = (double)((double)clock_speed / (double)frame_cycles);
@@ -576,11 +578,8 @@ void start_player(void)
   Vic->raster_lines = raster_lines;
   Vic->raster_row_cycles = rasterrow_cycles;
   Vic->set_timer_speed(100);
-#if DESKTOP
-  usbsid->USBSID_SetClockRate(clock_speed, true);
-#elif EMBEDDED
-  /* TODO: Do something */
-#endif
+  Cia1->tod_cycles = Cia2->tod_cycles = (Vic->cycles_per_sec / 10);
+  emu_sid_clock_rate(clock_speed);
 
   /* MICROSID player */
   load_microsid_player(songno);
@@ -69,10 +69,12 @@ extern int sidno;
 /* External emulator functions */
 extern void getinfo_USBSID(int clockspeed);
 extern void emulate_c64(void);
+extern void emu_map_io(void);
 extern void start_c64_test(void);
 extern void emu_write_byte(uint16_t addr, uint8_t data);
 extern uint8_t emu_dma_read_ram(uint16_t address);
 extern uint8_t emu_dma_write_ram(uint16_t address, uint8_t data);
+extern void emu_dma_write_block(uint16_t address, const uint8_t *data, size_t len);
 
 /* External emulator variables */
 extern mos6510 *Cpu;
@@ -120,6 +122,7 @@ void run_prg(uint8_t * binary_, size_t binsize_, bool loop)
     SID->sidno    = 0;        /* Default startnum */
     SID->sidone   = sidone;   /* Default */
     SID->sidtwo   = sidtwo;   /* Default */
+    emu_map_io();
   }
 
   /* Start loading file */
@@ -148,10 +151,8 @@ void run_prg(uint8_t * binary_, size_t binsize_, bool loop)
   if (log_instructions) Cpu->loginstructions = true;
 
   MOSDBG("[PRG] DMA copy binary to RAM start\n");
-  // memcpy(RAM+l_addr,prg+2,prg_size);
-  for(int i = l_addr; i < (l_addr+prg_size); i++) {
-    emu_dma_write_ram(i,prg[(i-l_addr)+2]);
-  }
+  /* prg_size includes the two load address bytes */
+  emu_dma_write_block(l_addr,prg+2,(prg_size > 2 ? (prg_size-2) : 0));
   MOSDBG("[PRG] DMA copy binary to RAM finished\n");
 
   {
@@ -55,6 +55,9 @@
 
 extern uint8_t emu_dma_read_ram(uint16_t address);
 extern void emu_dma_write_ram(uint16_t address, uint8_t data);
+extern void emu_dma_read_block(uint16_t address, uint8_t *data, size_t len);
+extern void emu_dma_write_block(uint16_t address, const uint8_t *data, size_t len);
+extern void emu_dma_fill(uint16_t address, uint8_t value, size_t len);
 extern "C" int reloc65(char** buf, int* fsize, int addr);
 
 volatile bool is_pal = true;
@@ -353,20 +356,19 @@ void psid_shutdown(void)
    environment. */
 static int psid_set_cbm80(uint16_t vec, uint16_t addr)
 {
-  unsigned int i;
   uint8_t cbm80[] = { 0x00, 0x00, 0x00, 0x00, 0xc3, 0xc2, 0xcd, 0x38, 0x30 };
+  uint8_t backup[sizeof(cbm80)];
 
   cbm80[0] = vec & 0xff;
   cbm80[1] = vec >> 8;
 
-  for (i = 0; i < sizeof(cbm80); i++) {
-    /* make backup of original content at 0x8000 */
-    emu_dma_write_ram((uint16_t)(addr + i), emu_dma_read_ram((uint16_t)(0x8000 + i)));
-    /* copy header */
-    emu_dma_write_ram((uint16_t)(0x8000 + i), cbm80[i]);
-  }
+  /* make backup of original content at 0x8000 */
+  emu_dma_read_block(0x8000, backup, sizeof(backup));
+  emu_dma_write_block(addr, backup, sizeof(backup));
+  /* copy header */
+  emu_dma_write_block(0x8000, cbm80, sizeof(cbm80));
 
-  return i;
+  return sizeof(cbm80);
 }
 
 void psid_init_tune(int install_driver_hook)
@@ -472,7 +474,6 @@ void psid_init_driver(void)
 
   uint16_t reloc_addr;
   uint16_t addr;
-  int i;
   int sync;
   // int sid2loc, sid3loc;
 
@@ -543,9 +544,7 @@ void psid_init_driver(void)
   // }
 
   /* Clear low memory to minimize the damage of PSIDs doing bad reads. */
-  for (addr = 0; addr < 0x0800; addr++) {
-    emu_dma_write_ram(addr, (uint8_t)0x00);
-  }
+  emu_dma_fill(0x0000, 0x00, 0x0800);
 
   /* Relocation of C64 PSID driver code. */
   reloc_addr_ext = reloc_addr = psid->start_page << 8;
@@ -560,44 +559,33 @@ void psid_init_driver(void)
     return;
   }
 
-  for (i = 0; i < psid_size; i++) {
-    emu_dma_write_ram((uint16_t)(reloc_addr + i), psid_reloc[i]);
-    /* if (i <= 0x20) MOSDBG("[PSID] driver @ $%04x:%02x %02x\n",
-      (uint16_t)(reloc_addr + i),
-      emu_dma_read_ram((uint16_t)(reloc_addr + i)),
-      psid_reloc[i]
-      ); */
-  }
+  emu_dma_write_block(reloc_addr, (const uint8_t *)psid_reloc, psid_size);
 
   /* Store binary C64 data. */
-  for (i = 0; i < psid->data_size; i++) {
-    emu_dma_write_ram((uint16_t)(psid->load_addr + i), psid->data[i]);
-    /* if (i <= 0x20) MOSDBG("[PSID] data @ $%04x:%02x %02x\n",
-      (uint16_t)(psid->load_addr + i),
-      emu_dma_read_ram((uint16_t)(psid->load_addr + i)),
-      psid->data[i]
-      ); */
-  }
+  emu_dma_write_block(psid->load_addr, psid->data, psid->data_size);
 
   /* Skip JMP and CBM80 reset vector. */
   addr = reloc_addr + 3 + 9 + 9;
 
   /* Store parameters for PSID player. */
-  emu_dma_write_ram(addr++, (uint8_t)(0)); /* reloc_addr + 21(0x15) */
-  emu_dma_write_ram(addr++, (uint8_t)(psid->songs));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->load_addr & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->load_addr >> 8));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->init_addr & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->init_addr >> 8));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->play_addr & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->play_addr >> 8));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->speed & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)((psid->speed >> 8) & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)((psid->speed >> 16) & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->speed >> 24));
-  emu_dma_write_ram(addr++, (uint8_t)((int)sync == MACHINE_SYNC_PAL ? 1 : 0));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->load_last_addr & 0xff));
-  emu_dma_write_ram(addr++, (uint8_t)(psid->load_last_addr >> 8));
+  const uint8_t params[] = {
+    (uint8_t)(0), /* reloc_addr + 21(0x15) */
+    (uint8_t)(psid->songs),
+    (uint8_t)(psid->load_addr & 0xff),
+    (uint8_t)(psid->load_addr >> 8),
+    (uint8_t)(psid->init_addr & 0xff),
+    (uint8_t)(psid->init_addr >> 8),
+    (uint8_t)(psid->play_addr & 0xff),
+    (uint8_t)(psid->play_addr >> 8),
+    (uint8_t)(psid->speed & 0xff),
+    (uint8_t)((psid->speed >> 8) & 0xff),
+    (uint8_t)((psid->speed >> 16) & 0xff),
+    (uint8_t)(psid->speed >> 24),
+    (uint8_t)((int)sync == MACHINE_SYNC_PAL ? 1 : 0),
+    (uint8_t)(psid->load_last_addr & 0xff),
+    (uint8_t)(psid->load_last_addr >> 8),
+  };
+  emu_dma_write_block(addr, params, sizeof(params));
 }
 
 uint16_t return_reloc_addr(void)
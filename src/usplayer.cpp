@@ -63,8 +63,10 @@
 #include <usplayer.h>
 #endif
 
+#include <types.h>
 #include <c64util.h>
 #include <wrappers.h>
+#include <sidbackend.h>
 
 using namespace std;
 
@@ -76,7 +78,7 @@ extern void emu_deinit(void);
 extern void emu_next_subtune(void);
 extern void emu_previous_subtune(void);
 extern void emu_pause_playing(bool pause);
-extern void emulate_c64_single(void);
+extern void emulate_c64_cycles(CPUCLOCK n_cycles);
 extern void hardwaresid_init(void);
 extern void hardwaresid_deinit(void);
 #if DESKTOP
@@ -96,28 +98,36 @@ extern void psid_init_tune(int install_driver_hook);
 extern void psid_init_driver(void);
 extern void psid_shutdown(void);
 extern void start_vsid_player(bool is_pal, bool loop);
+#if DESKTOP
+extern bool play_sid_dump(const char *path, int start_seconds);
+#endif
 extern volatile bool is_pal;
 char * filename;
 bool from_stdin = false;
 bool force_microsidplayer = false;
 bool threaded = true;
+bool dumpfile = false;
+int dump_start = 0;
 
 /* External emulation variables */
 #if DESKTOP
 extern volatile sig_atomic_t stop;
 extern volatile sig_atomic_t playing;
 extern volatile sig_atomic_t vsidpsid;
+extern volatile sig_atomic_t heatmap_dump_requested;
 #elif EMBEDDED
 extern volatile bool stop;
 extern volatile bool playing;
 extern volatile bool vsidpsid;
+extern volatile bool heatmap_dump_requested;
 #endif
 extern uint8_t songno;
 extern bool
   forcesockettwo,
   is_rsid,
   havefile,
-  prgfile;
+  prgfile,
+  use_superblocks;
 
 extern bool
   log_instructions,
@@ -130,6 +140,16 @@ extern bool
   log_vicrw,
   log_vicrrw,
   log_pla;
+extern const char * heatmap_file;
+extern const char * sid_output;
+extern int render_rate;
+extern bool render_8580;
+extern int run_seconds;
+extern int lookahead_frames;
+extern const char * sid_layout;
+#if DESKTOP
+extern sidbackend *emu_sid_output(void);
+#endif
 
 #if DESKTOP
 /* Local variables */
@@ -161,6 +181,13 @@ void inthand(int signum)
   playing = false;
 }
 
+#if !defined(_WIN32)
+void heatmap_hand(int signum)
+{
+  heatmap_dump_requested = 1;
+}
+#endif
+
 void run_player(void);
 
 /**
@@ -190,6 +217,11 @@ void* Emulation_Thread(void* arg)
 
 void run_player(void)
 {
+  if (dumpfile) {
+    vsidpsid = false;
+    play_sid_dump(filename, dump_start);
+    goto END;
+  }
   if (prgfile) {
     vsidpsid = false;
     run_prg(fname, true);
@@ -349,6 +381,9 @@ void wait_for_input(void)
           emu_pause_playing(true);
           emu_previous_subtune();
           emu_pause_playing(false);
+        } else if (pressed_key_char=='i') {
+          std::cout << "\rKEY_INFO       \n" << std::flush;
+          if (emu_sid_output()) emu_sid_output()->dump_stats();
         } else if (pressed_key_char==KEY_UP) {
           std::cout << "\rKEY_UP         " << std::flush;
         } else if (pressed_key_char==KEY_DOWN) {
@@ -383,6 +418,7 @@ void process_arguments(int argc, char **argv)
         std::string ext(fname.substr(ext_i+1));
         std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
         if(ext == "sid") { prgfile = false; havefile = true; }
+        else if(ext == "usd") { prgfile = false; dumpfile = true; havefile = true; }
         else if(ext == "prg") { prgfile = true; havefile = true; }
         else if(ext == "p00") { prgfile = true; havefile = true; }
         else { prgfile = true; havefile = true; }
@@ -434,6 +470,40 @@ void process_arguments(int argc, char **argv)
     else if (!strcmp(argv[param_count], "-t")) { /* disable threading */
       threaded = false;
     }
+    else if (!strcmp(argv[param_count], "-sb")) { /* run translated superblocks instead of single instructions */
+      use_superblocks = true;
+    }
+    else if (!strcmp(argv[param_count], "-heat")) { /* write a memory/IO access heat map at exit or on SIGUSR1 */
+      param_count++;
+      heatmap_file = argv[param_count];
+    }
+    else if (!strcmp(argv[param_count], "-out")) { /* SID output: usbsid (default), null, file:<path>, wav:<path> or dump:<path> */
+      param_count++;
+      sid_output = argv[param_count];
+    }
+    else if (!strcmp(argv[param_count], "-rate")) { /* wav output sample rate, 44100 (default) or 48000 */
+      param_count++;
+      render_rate = atoi(argv[param_count]);
+    }
+    else if (!strcmp(argv[param_count], "-8580")) { /* render 8580 instead of 6581 chips */
+      render_8580 = true;
+    }
+    else if (!strcmp(argv[param_count], "-ahead")) { /* let emulation run this many frames ahead of the hardware */
+      param_count++;
+      lookahead_frames = atoi(argv[param_count]);
+    }
+    else if (!strcmp(argv[param_count], "-sids")) { /* SID addresses e.g. d400,d420,de00 overriding the tune, up to 8 */
+      param_count++;
+      sid_layout = argv[param_count];
+    }
+    else if (!strcmp(argv[param_count], "-len")) { /* stop after this many seconds */
+      param_count++;
+      run_seconds = atoi(argv[param_count]);
+    }
+    else if (!strcmp(argv[param_count], "-pos")) { /* start a .usd dump at this many seconds */
+      param_count++;
+      dump_start = atoi(argv[param_count]);
+    }
   }
   MOSDBG("[USPLAYER ARGS] FILE:%d PRG:%d FORCEMICROSID:%d FORCESOCK2:%d SONGO:%d CPU:%d L:%d%d%d%d%d%d%d%d%d\n",
     havefile,
@@ -459,6 +529,9 @@ int main(int argc, char **argv)
 {
   songno = -1;
   signal(SIGINT, inthand);
+#if !defined(_WIN32)
+  signal(SIGUSR1, heatmap_hand);
+#endif
   process_arguments(argc,argv);
   init();
   MOSDBG("[USPLAYER MAIN] FILE:%d PRG:%d FORCEMICROSID:%d SONGO:%d CPU:%d L:%d%d%d%d%d%d%d%d%d\n",
@@ -547,7 +620,8 @@ void start_sidplayer(bool loop)
 
 void loop_sidplayer(void)
 {
-  emulate_c64_single();
+  /* Run a PAL raster line per call instead of a single instruction */
+  emulate_c64_cycles(63);
   return;
 }
 
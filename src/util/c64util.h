@@ -90,6 +90,13 @@
 /* For C64 */
 #define _MOS_LIKELY(x) (__builtin_expect(!!(x), 1))
 #define _MOS_UNLIKELY(x) (__builtin_expect(!!(x), 0))
+/* Force inlining of small hot path helpers */
+#define _MOS_INLINE inline __attribute__((always_inline))
+
+/* Tracing policies for the emulation hot path, trace_off compiles
+ * all log checks and debug bookkeeping out, trace_on keeps them in */
+struct trace_off { static constexpr bool enabled = false; };
+struct trace_on { static constexpr bool enabled = true; };
 
 static inline bool ISSET_BIT(unsigned int v, unsigned int b) {
   return (v & (1U << b)) != 0;
@@ -48,6 +48,35 @@ typedef uint64_t tick_t;
 typedef uint_fast16_t counter_t;
 typedef uint_fast8_t cycle_t;
 
+/* Machine run loop, see run_until */
+#define RUN_FOREVER (~(CPUCLOCK)0)
+typedef struct run_stop_t {
+  int_fast32_t pc;     /* stop before executing this address, -1 for none */
+  int_fast16_t opcode; /* stop after executing this opcode, -1 for none */
+} run_stop_t;
+typedef enum run_result_t {
+  kRunBudget = 0, /* target cycle reached */
+  kRunPC,
+  kRunOpcode,
+  kRunStop,       /* stop requested */
+} run_result_t;
+
+/* Timed machine commands, see emu_queue_commands */
+typedef enum emu_cmd_kind_t {
+  kCmdKeyDown = 0, /* a = row bit, b = column bit */
+  kCmdKeyUp,
+  kCmdSetPC,       /* addr */
+  kCmdHotReset,
+  kCmdWriteRam,    /* addr, a = value */
+} emu_cmd_kind_t;
+typedef struct emu_cmd_t {
+  emu_cmd_kind_t kind;
+  CPUCLOCK delay;  /* cycles after the command is picked up */
+  uint16_t addr;
+  uint8_t a;
+  uint8_t b;
+} emu_cmd_t;
+
 #define MILLI_PER_SECOND    (1000)
 #define MICRO_PER_SECOND    (1000 * 1000)
 #define NANO_PER_SECOND     (1000 * 1000 * 1000)
@@ -40,6 +40,7 @@
 #include <wrappers.h>
 
 #include <mos6510_cpu.h>
+#include <mos6526_cia.h>
 #include <mos6560_6561_vic.h>
 #include <mos6581_8580_sid.h>
 
@@ -52,9 +53,14 @@ extern void emu_write_byte(uint16_t addr, uint8_t data);
 extern uint8_t emu_dma_read_ram(uint16_t address);
 extern void emu_dma_write_ram(uint16_t address, uint8_t data);
 extern void emulate_c64(void);
+extern void emu_map_io(void);
+extern void emu_sid_clock_rate(long clockspeed);
+extern bool emu_queue_commands(const emu_cmd_t *cmds, int n_cmds);
 
 /* External emulator variables */
 extern mos6510 *Cpu;
+extern mos6526 *Cia1;
+extern mos6526 *Cia2;
 extern mos6560_6561 *Vic;
 extern mos6581_8580 *SID;
 extern bool
@@ -66,11 +72,6 @@ extern bool
   log_cia2rw,
   log_vicrw,
   log_vicrrw;
-#if DESKTOP
-extern volatile sig_atomic_t paused;
-#elif EMBEDDED
-extern volatile bool paused;
-#endif
 
 /* external USBSID variables */
 #if DESKTOP
@@ -142,13 +143,11 @@ void start_vsid_player(bool is_pal, bool loop)
   Vic->raster_lines = (pal_system ? 312 : 263);
   Vic->raster_row_cycles = (pal_system ? 63 : 65);;
   Vic->set_timer_speed(100);
-#if DESKTOP
-  usbsid->USBSID_SetClockRate(Vic->cycles_per_sec, true);
-#elif EMBEDDED
-  /* TODO: Do something */
-#endif
+  Cia1->tod_cycles = Cia2->tod_cycles = (Vic->cycles_per_sec / 10);
+  emu_sid_clock_rate(Vic->cycles_per_sec);
 
   SID->print_settings();
+  emu_map_io();
 
   MOSDBG("[VIC] RL:%u RRC:%u\n",Vic->raster_lines,Vic->raster_row_cycles);
 
@@ -196,9 +195,9 @@ void start_vsid_player(bool is_pal, bool loop)
 /**
  * @brief Select next or previous tune for VSIDPSID playing tunes
  * The psiddrv64 included in Vice that is used for VSID does not have
- * a keyboard handling routine. This function pauses the emulator,
- * then sets a new subtune, resets the emulator flags and jumps
- * back to the starting address by setting it to the program counter
+ * a keyboard handling routine. This function queues the new subtune
+ * number, a reset of the emulator flags and a jump back to the
+ * starting address, the run loop applies them between instructions
  *
  * @note This does not work for all tunes unfortunately
  *
@@ -206,11 +205,6 @@ void start_vsid_player(bool is_pal, bool loop)
  */
 void next_prev_tune(bool next)
 {
-  /* Set paused variable */
-  paused = true;
-  /* Sleep a single frame to allow the emulator to finish before pausing */
-  emu_sleep_us((uint64_t)Vic->refresh_rate);
-
   uint16_t max_songs = return_max_songs();
   uint16_t reloc_addr = return_reloc_addr();
   uint16_t jmp_addr = reloc_addr + 9;     /* Skip CM80 reset vector */
@@ -221,17 +215,18 @@ void next_prev_tune(bool next)
   next_song = ((next_song > max_songs) ? 1 : (next_song < 1) ? max_songs : next_song);
   start_song = next_song;
   MOSDBG("[USPLAYER] Next tune requested %d of %d\n", next_song, max_songs);
-  emu_dma_write_ram(drv_addr, (uint8_t)(next_song));
-  /* put song number into address 780/1/2 (A/X/Y) for use by BASIC tunes */
-  emu_dma_write_ram(780, (uint8_t)(next_song - 1));
-  emu_dma_write_ram(781, (uint8_t)(next_song - 1));
-  emu_dma_write_ram(782, (uint8_t)(next_song - 1));
   MOSDBG("[USPLAYER] reloc_addr: $%04x jmp_addr: $%04x drv_addr: $%04x nxt_addr: $%04x\n",
     reloc_addr,jmp_addr,drv_addr,nxt_addr);
   MOSDBG("[USPLAYER] JMP to $%04x\n", jmp_addr);
-  Cpu->pc(nxt_addr);
-  Cpu->hot_reset();
-  /* Unset paused variable */
-  paused = false;
+  const emu_cmd_t cmds[] = {
+    { kCmdWriteRam, 0, drv_addr, (uint8_t)(next_song) },
+    /* put song number into address 780/1/2 (A/X/Y) for use by BASIC tunes */
+    { kCmdWriteRam, 0, 780, (uint8_t)(next_song - 1) },
+    { kCmdWriteRam, 0, 781, (uint8_t)(next_song - 1) },
+    { kCmdWriteRam, 0, 782, (uint8_t)(next_song - 1) },
+    { kCmdSetPC, 0, nxt_addr },
+    { kCmdHotReset, 0 },
+  };
+  emu_queue_commands(cmds, count_of(cmds));
   return;
 }